@@ -7,18 +7,85 @@
 #include <queue>
 #include <iomanip>
 #include <algorithm>
+#include <span>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <latch>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <string>
+#include <stdexcept>
 #include "include/treenode.hpp"
 #include "include/threadpool.hpp"
 #include "include/paralleltreesearch.hpp"
+#include "include/flattree.hpp"
+#include "include/flattreefile.hpp"
+#include "include/flattreestream.hpp"
+#include "include/treeteardown.hpp"
+#include "include/arenatree.hpp"
+#include "include/numaplacement.hpp"
+
+// Distribution of one benchmark's timed repetitions, in milliseconds
+struct TimingSummary
+{
+    size_t samples = 0;
+    double minMs = 0.0;
+    double medianMs = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    double meanMs = 0.0;
+    double stddevMs = 0.0;
+
+    static TimingSummary of(std::vector<double> ms)
+    {
+        TimingSummary t;
+        t.samples = ms.size();
+        if (ms.empty())
+        {
+            return t;
+        }
+        std::sort(ms.begin(), ms.end());
+        // Nearest-rank percentile
+        auto rank = [&](double p)
+        {
+            size_t k = static_cast<size_t>(std::ceil(p * ms.size()));
+            return ms[std::min(ms.size(), std::max<size_t>(k, 1)) - 1];
+        };
+        t.minMs = ms.front();
+        t.maxMs = ms.back();
+        t.medianMs = ms.size() % 2 ? ms[ms.size() / 2] : (ms[ms.size() / 2 - 1] + ms[ms.size() / 2]) / 2.0;
+        t.p95Ms = rank(0.95);
+        t.p99Ms = rank(0.99);
+        double sum = 0.0;
+        for (double v : ms)
+        {
+            sum += v;
+        }
+        t.meanMs = sum / ms.size();
+        double squares = 0.0;
+        for (double v : ms)
+        {
+            squares += (v - t.meanMs) * (v - t.meanMs);
+        }
+        t.stddevMs = ms.size() > 1 ? std::sqrt(squares / (ms.size() - 1)) : 0.0;
+        return t;
+    }
+};
 
 // Performance metrics structure
 struct PerformanceMetrics
 {
     std::string algorithmName;
+    // Median of timing, or the single measurement when there is no timing
     double executionTimeMs;
     size_t nodesVisited;
     bool found;
     int depth;
+    TimingSummary timing{};
 };
 
 // Tree generator class
@@ -74,6 +141,37 @@ public:
         return node;
     }
 
+    // Random branching like generateRandomTree, but grown level by level.
+    // generateRandomTree spends most of a large node budget down its first
+    // surviving child chain; this keeps the depth logarithmic.
+    std::shared_ptr<TreeNode<int>> generateRandomBushyTree(int maxNodes, int minChildren, int maxChildren, int &nodeCounter)
+    {
+        if (nodeCounter >= maxNodes)
+        {
+            return nullptr;
+        }
+
+        auto root = std::make_shared<TreeNode<int>>(nodeCounter++);
+        std::uniform_int_distribution<int> dist(minChildren, maxChildren);
+        std::queue<TreeNode<int> *> frontier;
+        frontier.push(root.get());
+
+        while (!frontier.empty() && nodeCounter < maxNodes)
+        {
+            TreeNode<int> *node = frontier.front();
+            frontier.pop();
+            int numChildren = dist(rng);
+            for (int i = 0; i < numChildren && nodeCounter < maxNodes; ++i)
+            {
+                auto child = std::make_shared<TreeNode<int>>(nodeCounter++);
+                frontier.push(child.get());
+                node->addChild(std::move(child));
+            }
+        }
+
+        return root;
+    }
+
     // Generate a skewed tree (worst case for some algorithms)
     std::shared_ptr<TreeNode<int>> generateSkewedTree(int depth, int &nodeCounter)
     {
@@ -95,6 +193,345 @@ public:
 
         return node;
     }
+
+    // Arena-backed balanced tree; same node numbering as generateBalancedTree
+    ArenaTreeNode<int> *generateBalancedTree(ArenaTree<int> &tree, int depth, int branchingFactor, int &nodeCounter)
+    {
+        auto *node = fillBalanced(tree, depth, branchingFactor, nodeCounter);
+        if (!tree.root())
+        {
+            tree.setRoot(node);
+        }
+        return node;
+    }
+
+    // Parallel generators. The top levels are expanded on the calling thread
+    // until there are a few subtrees per worker; each subtree is then built
+    // by a job on the shared pool. Node numbering is the sequential
+    // generators' (preorder), so the trees are identical.
+    std::shared_ptr<TreeNode<int>> generateBalancedTreeParallel(int depth, int branchingFactor, int &nodeCounter)
+    {
+        std::vector<std::function<void()>> jobs;
+        auto root = expandBalanced(depth, branchingFactor, nodeCounter, splitLevels(depth, branchingFactor), jobs);
+        runParallel(jobs);
+        nodeCounter += static_cast<int>(balancedSize(depth, branchingFactor));
+        return root;
+    }
+
+    // Subtrees go into their own shards and are linked in order afterwards
+    ArenaTreeNode<int> *generateBalancedTreeParallel(ArenaTree<int> &tree, int depth, int branchingFactor, int &nodeCounter)
+    {
+        std::vector<PendingShard> pending;
+        long long idOffset = static_cast<long long>(tree.size()) - nodeCounter;
+        auto *root = expandBalanced(tree, idOffset, depth, branchingFactor, nodeCounter,
+                                    splitLevels(depth, branchingFactor), pending);
+
+        std::vector<std::unique_ptr<ArenaTree<int>::Shard>> shards(pending.size());
+        std::vector<ArenaTreeNode<int> *> roots(pending.size());
+        std::vector<std::function<void()>> jobs;
+        for (size_t k = 0; k < pending.size(); ++k)
+        {
+            jobs.push_back([this, &pending, &shards, &roots, idOffset, branchingFactor, k]
+                           {
+                int counter = pending[k].first;
+                shards[k] = std::make_unique<ArenaTree<int>::Shard>(static_cast<size_t>(counter + idOffset));
+                roots[k] = fillBalanced(*shards[k], pending[k].depth, branchingFactor, counter); });
+        }
+        runParallel(jobs);
+
+        for (size_t k = 0; k < pending.size(); ++k)
+        {
+            tree.adopt(std::move(*shards[k]));
+            tree.addChild(pending[k].parent, roots[k]);
+        }
+        if (!tree.root())
+        {
+            tree.setRoot(root);
+        }
+        nodeCounter += static_cast<int>(balancedSize(depth, branchingFactor));
+        return root;
+    }
+
+    // Every subtree's size and position is known, so workers fill disjoint
+    // slices of the preorder arrays directly
+    FlatTree<int> generateBalancedFlatTree(int depth, int branchingFactor, int &nodeCounter)
+    {
+        size_t n = static_cast<size_t>(balancedSize(depth, branchingFactor));
+        FlatArrays arrays{std::vector<int>(n), std::vector<FlatTree<int>::Index>(n), std::vector<FlatTree<int>::Index>(n)};
+        std::vector<std::function<void()>> jobs;
+        expandBalancedFlat(arrays, 0, depth, branchingFactor, nodeCounter, splitLevels(depth, branchingFactor), jobs);
+        runParallel(jobs);
+        nodeCounter += static_cast<int>(n);
+        return FlatTree<int>::fromArrays(std::move(arrays.values), std::move(arrays.subtreeSizes), std::move(arrays.childCounts));
+    }
+
+    // Same shape and numbering as generateRandomTree, drawing from rng in
+    // the same order; random shapes can't be split up front, so this part
+    // stays sequential (it only appends to three arrays)
+    FlatTree<int> generateRandomFlatTree(int maxNodes, int minChildren, int maxChildren, int &nodeCounter)
+    {
+        FlatTree<int>::Builder builder;
+        if (nodeCounter < maxNodes)
+        {
+            builder.reserve(maxNodes - nodeCounter);
+            appendRandom(builder, maxNodes, minChildren, maxChildren, nodeCounter);
+        }
+        return builder.build();
+    }
+
+    // generateRandomTree's tree, with the nodes allocated in parallel
+    std::shared_ptr<TreeNode<int>> generateRandomTreeParallel(int maxNodes, int minChildren, int maxChildren, int &nodeCounter)
+    {
+        FlatTree<int> shape = generateRandomFlatTree(maxNodes, minChildren, maxChildren, nodeCounter);
+        if (shape.empty())
+        {
+            return nullptr;
+        }
+        size_t workers = ThreadPool<void>::shared()->getThreadCount();
+        size_t grain = std::max<size_t>(1024, shape.size() / (4 * workers));
+        std::vector<std::function<void()>> jobs;
+        auto root = expandFlat(shape, 0, grain, jobs);
+        runParallel(jobs);
+        return root;
+    }
+
+private:
+    struct PendingShard
+    {
+        ArenaTreeNode<int> *parent;
+        int depth;
+        int first;
+    };
+
+    struct FlatArrays
+    {
+        std::vector<int> values;
+        std::vector<FlatTree<int>::Index> subtreeSizes;
+        std::vector<FlatTree<int>::Index> childCounts;
+    };
+
+    static long long balancedSize(int depth, int branchingFactor)
+    {
+        long long size = 1;
+        for (int d = 0; d < depth; ++d)
+        {
+            size = 1 + branchingFactor * size;
+        }
+        return size;
+    }
+
+    // Levels to expand before handing out subtrees: enough for a few per
+    // worker, and never all the way down
+    static int splitLevels(int depth, int branchingFactor)
+    {
+        size_t want = 4 * ThreadPool<void>::shared()->getThreadCount();
+        size_t subtrees = 1;
+        int levels = 0;
+        while (levels < depth - 1 && subtrees < want)
+        {
+            subtrees *= static_cast<size_t>(branchingFactor);
+            ++levels;
+        }
+        return levels;
+    }
+
+    // Run every job on the shared pool and wait for all of them
+    static void runParallel(std::vector<std::function<void()>> &jobs)
+    {
+        std::latch done(static_cast<std::ptrdiff_t>(jobs.size()));
+        auto pool = ThreadPool<void>::shared();
+        for (auto &job : jobs)
+        {
+            pool->enqueue([&job, &done]
+                          {
+                job();
+                done.count_down(); });
+        }
+        done.wait();
+    }
+
+    template <typename Arena>
+    ArenaTreeNode<int> *fillBalanced(Arena &tree, int depth, int branchingFactor, int &nodeCounter)
+    {
+        auto *node = tree.createNode(nodeCounter++);
+
+        if (depth > 0)
+        {
+            tree.reserveChildren(node, branchingFactor);
+            for (int i = 0; i < branchingFactor; ++i)
+            {
+                tree.addChild(node, fillBalanced(tree, depth - 1, branchingFactor, nodeCounter));
+            }
+        }
+        return node;
+    }
+
+    // Create the top levels of a balanced tree numbered from first; the
+    // subtrees below them become jobs writing into their parent's slot
+    std::shared_ptr<TreeNode<int>> expandBalanced(int depth, int branchingFactor, int first, int levels,
+                                                  std::vector<std::function<void()>> &jobs)
+    {
+        auto node = std::make_shared<TreeNode<int>>(first);
+        if (depth == 0)
+        {
+            return node;
+        }
+
+        node->children.resize(branchingFactor);
+        int childSize = static_cast<int>(balancedSize(depth - 1, branchingFactor));
+        for (int i = 0; i < branchingFactor; ++i)
+        {
+            int childFirst = first + 1 + i * childSize;
+            auto *slot = &node->children[i];
+            if (levels > 1)
+            {
+                *slot = expandBalanced(depth - 1, branchingFactor, childFirst, levels - 1, jobs);
+            }
+            else
+            {
+                jobs.push_back([this, slot, depth, branchingFactor, childFirst]
+                               {
+                    int counter = childFirst;
+                    *slot = generateBalancedTree(depth - 1, branchingFactor, counter); });
+            }
+        }
+        return node;
+    }
+
+    ArenaTreeNode<int> *expandBalanced(ArenaTree<int> &tree, long long idOffset, int depth, int branchingFactor, int first,
+                                       int levels, std::vector<PendingShard> &pending)
+    {
+        auto *node = tree.createNode(first, static_cast<size_t>(first + idOffset));
+        if (depth == 0)
+        {
+            return node;
+        }
+
+        tree.reserveChildren(node, branchingFactor);
+        int childSize = static_cast<int>(balancedSize(depth - 1, branchingFactor));
+        for (int i = 0; i < branchingFactor; ++i)
+        {
+            int childFirst = first + 1 + i * childSize;
+            if (levels > 1)
+            {
+                tree.addChild(node, expandBalanced(tree, idOffset, depth - 1, branchingFactor, childFirst, levels - 1, pending));
+            }
+            else
+            {
+                pending.push_back({node, depth - 1, childFirst});
+            }
+        }
+        return node;
+    }
+
+    // Fill the subtree at preorder position pos, numbered from first + pos
+    static void fillBalancedFlat(FlatArrays &arrays, size_t pos, int depth, int branchingFactor, int first)
+    {
+        arrays.values[pos] = first + static_cast<int>(pos);
+        arrays.subtreeSizes[pos] = static_cast<FlatTree<int>::Index>(balancedSize(depth, branchingFactor));
+        arrays.childCounts[pos] = depth > 0 ? branchingFactor : 0;
+        if (depth == 0)
+        {
+            return;
+        }
+        size_t childSize = static_cast<size_t>(balancedSize(depth - 1, branchingFactor));
+        for (int i = 0; i < branchingFactor; ++i)
+        {
+            fillBalancedFlat(arrays, pos + 1 + i * childSize, depth - 1, branchingFactor, first);
+        }
+    }
+
+    static void expandBalancedFlat(FlatArrays &arrays, size_t pos, int depth, int branchingFactor, int first, int levels,
+                                   std::vector<std::function<void()>> &jobs)
+    {
+        arrays.values[pos] = first + static_cast<int>(pos);
+        arrays.subtreeSizes[pos] = static_cast<FlatTree<int>::Index>(balancedSize(depth, branchingFactor));
+        arrays.childCounts[pos] = depth > 0 ? branchingFactor : 0;
+        if (depth == 0)
+        {
+            return;
+        }
+        size_t childSize = static_cast<size_t>(balancedSize(depth - 1, branchingFactor));
+        for (int i = 0; i < branchingFactor; ++i)
+        {
+            size_t childPos = pos + 1 + i * childSize;
+            if (levels > 1)
+            {
+                expandBalancedFlat(arrays, childPos, depth - 1, branchingFactor, first, levels - 1, jobs);
+            }
+            else
+            {
+                jobs.push_back([&arrays, childPos, depth, branchingFactor, first]
+                               { fillBalancedFlat(arrays, childPos, depth - 1, branchingFactor, first); });
+            }
+        }
+    }
+
+    // Mirrors generateRandomTree's recursion and rng draws exactly
+    void appendRandom(FlatTree<int>::Builder &builder, int maxNodes, int minChildren, int maxChildren, int &nodeCounter)
+    {
+        builder.open(nodeCounter++);
+
+        if (nodeCounter < maxNodes)
+        {
+            std::uniform_int_distribution<int> dist(minChildren, maxChildren);
+            int numChildren = dist(rng);
+
+            for (int i = 0; i < numChildren && nodeCounter < maxNodes; ++i)
+            {
+                appendRandom(builder, maxNodes, minChildren, maxChildren, nodeCounter);
+            }
+        }
+
+        builder.close();
+    }
+
+    // Build the pointer subtree rooted at preorder index i of shape
+    static std::shared_ptr<TreeNode<int>> buildFromFlat(const FlatTree<int> &shape, size_t i)
+    {
+        auto root = std::make_shared<TreeNode<int>>(shape.value(i));
+        std::vector<std::pair<size_t, TreeNode<int> *>> stack;
+        stack.push_back({i, root.get()});
+        while (!stack.empty())
+        {
+            auto [j, node] = stack.back();
+            stack.pop_back();
+            node->children.reserve(shape.childCount(j));
+            size_t c = j + 1;
+            for (size_t k = 0; k < shape.childCount(j); ++k)
+            {
+                auto child = std::make_shared<TreeNode<int>>(shape.value(c));
+                node->children.push_back(child);
+                stack.push_back({c, child.get()});
+                c += shape.subtreeSize(c);
+            }
+        }
+        return root;
+    }
+
+    // Walk the shape from i, leaving every subtree of at most grain nodes to a job
+    static std::shared_ptr<TreeNode<int>> expandFlat(const FlatTree<int> &shape, size_t i, size_t grain,
+                                                     std::vector<std::function<void()>> &jobs)
+    {
+        auto node = std::make_shared<TreeNode<int>>(shape.value(i));
+        node->children.resize(shape.childCount(i));
+        size_t c = i + 1;
+        for (size_t k = 0; k < shape.childCount(i); ++k)
+        {
+            auto *slot = &node->children[k];
+            if (shape.subtreeSize(c) <= grain)
+            {
+                jobs.push_back([&shape, slot, c]
+                               { *slot = buildFromFlat(shape, c); });
+            }
+            else
+            {
+                *slot = expandFlat(shape, c, grain, jobs);
+            }
+            c += shape.subtreeSize(c);
+        }
+        return node;
+    }
 };
 
 // DFS Search
@@ -102,25 +539,32 @@ class DFSSearch
 {
 private:
     size_t nodesVisited;
+    std::vector<const TreeNode<int> *> stack;
 
-    bool dfsHelper(std::shared_ptr<TreeNode<int>> node, int target)
+    // Explicit stack so deep trees cannot overflow the call stack
+    bool dfsHelper(const std::shared_ptr<TreeNode<int>> &root, int target)
     {
-        if (!node)
-            return false;
-
-        nodesVisited++;
+        stack.clear();
+        stack.push_back(root.get());
 
-        if (node->data == target)
+        while (!stack.empty())
         {
-            return true;
-        }
+            const TreeNode<int> *node = stack.back();
+            stack.pop_back();
+            if (!node)
+                continue;
 
-        for (auto &child : node->children)
-        {
-            if (dfsHelper(child, target))
+            nodesVisited++;
+
+            if (node->data == target)
             {
                 return true;
             }
+
+            for (size_t i = node->children.size(); i-- > 0;)
+            {
+                stack.push_back(node->children[i].get());
+            }
         }
 
         return false;
@@ -131,9 +575,9 @@ public:
     {
         nodesVisited = 0;
 
-        auto start = std::chrono::high_resolution_clock::now();
+        auto start = std::chrono::steady_clock::now();
         bool found = dfsHelper(root, target);
-        auto end = std::chrono::high_resolution_clock::now();
+        auto end = std::chrono::steady_clock::now();
 
         double duration = std::chrono::duration<double, std::milli>(end - start).count();
 
@@ -152,7 +596,7 @@ public:
     {
         nodesVisited = 0;
 
-        auto start = std::chrono::high_resolution_clock::now();
+        auto start = std::chrono::steady_clock::now();
 
         std::queue<std::shared_ptr<TreeNode<int>>> q;
         q.push(root);
@@ -177,238 +621,1763 @@ public:
             }
         }
 
-        auto end = std::chrono::high_resolution_clock::now();
+        auto end = std::chrono::steady_clock::now();
         double duration = std::chrono::duration<double, std::milli>(end - start).count();
 
         return {"BFS", duration, nodesVisited, found, -1};
     }
 };
 
-// Helper to reset tree for parallel search
-void resetTree(std::shared_ptr<TreeNode<int>> node)
-{
-    if (!node)
-        return;
-    node->visited.store(false);
-    for (auto &child : node->children)
-    {
-        resetTree(child);
-    }
-}
-
 // Helper to count total nodes
-int countNodes(std::shared_ptr<TreeNode<int>> node)
+int countNodes(std::shared_ptr<TreeNode<int>> root)
 {
-    if (!node)
-        return 0;
-    int count = 1;
-    for (auto &child : node->children)
+    int count = 0;
+    std::vector<const TreeNode<int> *> stack;
+    stack.push_back(root.get());
+    while (!stack.empty())
     {
-        count += countNodes(child);
+        const TreeNode<int> *node = stack.back();
+        stack.pop_back();
+        if (!node)
+            continue;
+        count++;
+        for (auto &child : node->children)
+        {
+            stack.push_back(child.get());
+        }
     }
     return count;
 }
 
-// Helper to calculate tree depth
-int calculateDepth(std::shared_ptr<TreeNode<int>> node)
+// Helper to calculate tree depth (edges on the longest root-to-leaf path)
+int calculateDepth(std::shared_ptr<TreeNode<int>> root)
 {
-    if (!node || node->isLeaf())
+    if (!root)
         return 0;
     int maxDepth = 0;
-    for (auto &child : node->children)
+    std::vector<std::pair<const TreeNode<int> *, int>> stack;
+    stack.push_back({root.get(), 0});
+    while (!stack.empty())
     {
-        maxDepth = std::max(maxDepth, calculateDepth(child));
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+        maxDepth = std::max(maxDepth, depth);
+        for (auto &child : node->children)
+        {
+            if (child)
+                stack.push_back({child.get(), depth + 1});
+        }
     }
-    return maxDepth + 1;
+    return maxDepth;
 }
 
-// Print results table
-void printResults(const std::vector<PerformanceMetrics> &results, int totalNodes, int treeDepth)
+// Command-line options (see usage())
+struct BenchmarkOptions
 {
-    std::cout << "\n"
-              << std::string(80, '=') << "\n";
-    std::cout << "BENCHMARK RESULTS\n";
-    std::cout << std::string(80, '=') << "\n";
-    std::cout << "Tree Size: " << totalNodes << " nodes\n";
-    std::cout << "Tree Depth: " << treeDepth << "\n";
-    std::cout << std::string(80, '-') << "\n";
-
-    std::cout << std::left << std::setw(25) << "Algorithm"
-              << std::right << std::setw(15) << "Time (ms)"
-              << std::setw(15) << "Nodes Visited"
-              << std::setw(12) << "Found"
-              << std::setw(13) << "Speedup" << "\n";
-    std::cout << std::string(80, '-') << "\n";
-
-    double baselineTime = results[0].executionTimeMs;
+    int warmups = 1;
+    int repetitions = 5;
+    // Test numbers to run; empty runs all of them
+    std::vector<int> tests;
+    std::vector<int> threadCounts = {2, 4, 8, 16};
+    SplitPolicy splitPolicy;
+    std::string jsonPath;
+    std::string csvPath;
 
-    for (const auto &result : results)
+    bool wants(int test) const
     {
-        double speedup = baselineTime / result.executionTimeMs;
+        return tests.empty() || std::find(tests.begin(), tests.end(), test) != tests.end();
+    }
 
-        std::cout << std::left << std::setw(25) << result.algorithmName
-                  << std::right << std::setw(15) << std::fixed << std::setprecision(3) << result.executionTimeMs
-                  << std::setw(15) << result.nodesVisited
-                  << std::setw(12) << (result.found ? "Yes" : "No")
-                  << std::setw(13) << std::fixed << std::setprecision(2) << speedup << "x\n";
+    bool wantsAny(std::initializer_list<int> section) const
+    {
+        return std::any_of(section.begin(), section.end(), [this](int t)
+                           { return wants(t); });
     }
+};
 
-    std::cout << std::string(80, '=') << "\n\n";
-}
+BenchmarkOptions options;
 
-// Run benchmark suite
-void runBenchmark(const std::string &testName, std::shared_ptr<TreeNode<int>> tree, int target)
+void usage(std::ostream &out)
 {
-    std::cout << "\n"
-              << std::string(80, '=') << "\n";
-    std::cout << "RUNNING: " << testName << "\n";
-    std::cout << "Target value: " << target << "\n";
-
-    int totalNodes = countNodes(tree);
-    int treeDepth = calculateDepth(tree);
-
-    std::vector<PerformanceMetrics> results;
-
-    // DFS Search
-    DFSSearch dfs;
-    results.push_back(dfs.search(tree, target));
-
-    // BFS Search
-    BFSSearch bfs;
-    results.push_back(bfs.search(tree, target));
-
-    // Parallel Search with different thread counts
-    std::vector<int> threadCounts = {2, 4, 8, 16};
+    out << "Usage: benchmark [options]\n"
+           "  --tests LIST             tests to run, e.g. 1,3-5,9 (default: all, 1-26)\n"
+           "  --warmup N               untimed runs before measuring (default 1)\n"
+           "  --reps N                 timed repetitions (default 5)\n"
+           "  --threads LIST           searcher thread counts for tests 1-14 (default 2,4,8,16)\n"
+           "  --split adaptive|fixed   work splitting policy (default adaptive)\n"
+           "  --cutoff N               fixed policy: depth where spawning stops (implies --split fixed)\n"
+           "  --max-par-children N     fixed policy: children spawned per node (implies --split fixed)\n"
+           "  --json FILE              write results of tests 1-14 and 24-26 as JSON\n"
+           "  --csv FILE               write results of tests 1-14 and 24-26 as CSV\n"
+           "Tests 1-14 report the median, p95, p99 and stddev of the repetitions;\n"
+           "tests 15-23 run once and print their own tables. Test 24 sweeps 1 to\n"
+           "hardware_concurrency threads over several tree shapes and target positions;\n"
+           "test 25 compares unpinned, pinned and NUMA-placed full scans; test 26\n"
+           "compares the generic and lean (LeanTreeSearch) kernels.\n";
+}
 
-    for (int numThreads : threadCounts)
+// "1,3-5" -> {1, 3, 4, 5}
+std::vector<int> parseList(const std::string &flag, const std::string &text)
+{
+    std::vector<int> out;
+    std::stringstream in(text);
+    std::string item;
+    try
     {
-        resetTree(tree);
-        ParallelTreeSearch<int> parallelSearch(numThreads);
-
-        auto start = std::chrono::high_resolution_clock::now();
-        auto result = parallelSearch.search(tree, target);
-        auto end = std::chrono::high_resolution_clock::now();
-
-        double duration = std::chrono::duration<double, std::milli>(end - start).count();
-        size_t nodesVisited = parallelSearch.getNodesVisited();
-
-        std::string name = "Parallel (" + std::to_string(numThreads) + " threads)";
-        results.push_back({name, duration, nodesVisited, result != nullptr, -1});
+        while (std::getline(in, item, ','))
+        {
+            size_t dash = item.find('-', 1);
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int v = first; v <= last; ++v)
+            {
+                out.push_back(v);
+            }
+        }
     }
-
-    printResults(results, totalNodes, treeDepth);
+    catch (const std::logic_error &)
+    {
+        throw std::invalid_argument("bad list for " + flag + ": " + text);
+    }
+    if (out.empty())
+    {
+        throw std::invalid_argument("empty list for " + flag);
+    }
+    return out;
 }
 
-int main()
+int parseCount(const std::string &flag, const std::string &text, int minimum)
 {
-    TreeGenerator generator;
-
-    std::cout << "\n";
+    try
+    {
+        size_t used = 0;
+        int v = std::stoi(text, &used);
+        if (used == text.size() && v >= minimum)
+        {
+            return v;
+        }
+    }
+    catch (const std::logic_error &)
+    {
+    }
+    throw std::invalid_argument("bad value for " + flag + ": " + text);
+}
+
+// Returns false if the program should exit after printing usage
+bool parseOptions(int argc, char **argv, BenchmarkOptions &opts)
+{
+    bool fixed = false;
+    int cutoff = PAR_CUTOFF_DEPTH;
+    int maxChildren = MAX_PAR_CHILDREN;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h")
+        {
+            usage(std::cout);
+            return false;
+        }
+        if (i + 1 == argc)
+        {
+            throw std::invalid_argument("missing value for " + flag);
+        }
+        std::string value = argv[++i];
+        if (flag == "--tests")
+            opts.tests = parseList(flag, value);
+        else if (flag == "--warmup")
+            opts.warmups = parseCount(flag, value, 0);
+        else if (flag == "--reps")
+            opts.repetitions = parseCount(flag, value, 1);
+        else if (flag == "--threads")
+        {
+            opts.threadCounts = parseList(flag, value);
+            for (int t : opts.threadCounts)
+            {
+                parseCount(flag, std::to_string(t), 1);
+            }
+        }
+        else if (flag == "--split")
+        {
+            if (value != "adaptive" && value != "fixed")
+            {
+                throw std::invalid_argument("--split must be adaptive or fixed");
+            }
+            fixed = value == "fixed";
+        }
+        else if (flag == "--cutoff")
+        {
+            cutoff = parseCount(flag, value, 0);
+            fixed = true;
+        }
+        else if (flag == "--max-par-children")
+        {
+            maxChildren = parseCount(flag, value, 1);
+            fixed = true;
+        }
+        else if (flag == "--json")
+            opts.jsonPath = value;
+        else if (flag == "--csv")
+            opts.csvPath = value;
+        else
+            throw std::invalid_argument("unknown option " + flag);
+    }
+    opts.splitPolicy = fixed ? SplitPolicy::fixed(cutoff, static_cast<size_t>(maxChildren)) : SplitPolicy::adaptive();
+    return true;
+}
+
+// Call run() options.warmups times untimed, then options.repetitions times
+// timed. run returns nothing; it keeps whatever else it measured itself.
+template <typename Run>
+TimingSummary measure(Run &&run)
+{
+    for (int i = 0; i < options.warmups; ++i)
+    {
+        run();
+    }
+    std::vector<double> samples;
+    samples.reserve(options.repetitions);
+    for (int i = 0; i < options.repetitions; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return TimingSummary::of(std::move(samples));
+}
+
+PerformanceMetrics measured(const std::string &name, const TimingSummary &timing, size_t nodesVisited, bool found)
+{
+    return {name, timing.medianMs, nodesVisited, found, -1, timing};
+}
+
+// Everything printResults showed, for --json and --csv
+struct ReportRow
+{
+    std::string test;
+    PerformanceMetrics metrics;
+};
+
+std::vector<ReportRow> reportRows;
+
+std::string jsonString(const std::string &s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// Quote a CSV field that needs it
+std::string csvField(const std::string &s)
+{
+    if (s.find_first_of(",\"\n") == std::string::npos)
+    {
+        return s;
+    }
+    std::string out = "\"";
+    for (char c : s)
+    {
+        out += c;
+        if (c == '"')
+        {
+            out += '"';
+        }
+    }
+    return out + "\"";
+}
+
+void writeJsonReport(const std::string &path)
+{
+    std::ofstream out(path);
+    const SplitPolicy &policy = options.splitPolicy;
+    out << std::setprecision(6) << "{\n";
+    out << "  \"compiler\": " << jsonString(__VERSION__) << ",\n";
+    out << "  \"scanKernel\": " << jsonString(simdScanBackend()) << ",\n";
+    out << "  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"warmups\": " << options.warmups << ",\n";
+    out << "  \"repetitions\": " << options.repetitions << ",\n";
+    out << "  \"splitPolicy\": {\"mode\": " << jsonString(policy.mode == SplitMode::Adaptive ? "adaptive" : "fixed")
+        << ", \"cutoffDepth\": " << policy.cutoffDepth << ", \"maxParChildren\": " << policy.maxParChildren << "},\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < reportRows.size(); ++i)
+    {
+        const auto &m = reportRows[i].metrics;
+        const auto &t = m.timing;
+        out << (i ? "," : "") << "\n    {\"test\": " << jsonString(reportRows[i].test)
+            << ", \"algorithm\": " << jsonString(m.algorithmName)
+            << ", \"samples\": " << t.samples << ", \"minMs\": " << t.minMs << ", \"medianMs\": " << t.medianMs
+            << ", \"p95Ms\": " << t.p95Ms << ", \"p99Ms\": " << t.p99Ms << ", \"maxMs\": " << t.maxMs
+            << ", \"meanMs\": " << t.meanMs << ", \"stddevMs\": " << t.stddevMs
+            << ", \"nodesVisited\": " << m.nodesVisited << ", \"found\": " << (m.found ? "true" : "false") << "}";
+    }
+    out << "\n  ]\n}\n";
+    if (!out)
+    {
+        throw std::runtime_error("Failed writing " + path);
+    }
+}
+
+void writeCsvReport(const std::string &path)
+{
+    std::ofstream out(path);
+    out << std::setprecision(6);
+    out << "test,algorithm,samples,min_ms,median_ms,p95_ms,p99_ms,max_ms,mean_ms,stddev_ms,nodes_visited,found\n";
+    for (const auto &row : reportRows)
+    {
+        const auto &m = row.metrics;
+        const auto &t = m.timing;
+        out << csvField(row.test) << "," << csvField(m.algorithmName) << "," << t.samples << "," << t.minMs << ","
+            << t.medianMs << "," << t.p95Ms << "," << t.p99Ms << "," << t.maxMs << "," << t.meanMs << ","
+            << t.stddevMs << "," << m.nodesVisited << "," << (m.found ? 1 : 0) << "\n";
+    }
+    if (!out)
+    {
+        throw std::runtime_error("Failed writing " + path);
+    }
+}
+
+// Print results table
+void printResults(const std::vector<PerformanceMetrics> &results, int totalNodes, int treeDepth)
+{
+    const int width = 99;
+    std::cout << "\n"
+              << std::string(width, '=') << "\n";
+    std::cout << "BENCHMARK RESULTS\n";
+    std::cout << std::string(width, '=') << "\n";
+    std::cout << "Tree Size: " << totalNodes << " nodes\n";
+    std::cout << "Tree Depth: " << treeDepth << "\n";
+    std::cout << "Repetitions: " << options.repetitions << " (after " << options.warmups << " warm-up)\n";
+    std::cout << std::string(width, '-') << "\n";
+
+    std::cout << std::left << std::setw(25) << "Algorithm"
+              << std::right << std::setw(12) << "Median (ms)"
+              << std::setw(10) << "p95"
+              << std::setw(10) << "p99"
+              << std::setw(10) << "Stddev"
+              << std::setw(15) << "Nodes Visited"
+              << std::setw(7) << "Found"
+              << std::setw(10) << "Speedup" << "\n";
+    std::cout << std::string(width, '-') << "\n";
+
+    // Speedups compare medians against the first row
+    double baselineTime = results[0].executionTimeMs;
+
+    for (const auto &result : results)
+    {
+        double speedup = baselineTime / result.executionTimeMs;
+        const TimingSummary &t = result.timing;
+
+        std::cout << std::left << std::setw(25) << result.algorithmName
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(3) << result.executionTimeMs
+                  << std::setw(10) << t.p95Ms
+                  << std::setw(10) << t.p99Ms
+                  << std::setw(10) << t.stddevMs
+                  << std::setw(15) << result.nodesVisited
+                  << std::setw(7) << (result.found ? "Yes" : "No")
+                  << std::setw(9) << std::fixed << std::setprecision(2) << speedup << "x\n";
+    }
+
+    std::cout << std::string(width, '=') << "\n\n";
+}
+
+void recordResults(const std::string &testName, const std::vector<PerformanceMetrics> &results)
+{
+    for (const auto &result : results)
+    {
+        reportRows.push_back({testName, result});
+    }
+}
+
+// A finished test's tree is freed on the shared pool while the next one is
+// built; anything timed waits for that first so it doesn't skew results
+std::future<void> pendingTeardown;
+
+void awaitTeardown()
+{
+    if (pendingTeardown.valid())
+    {
+        pendingTeardown.get();
+    }
+}
+
+void retireTree(std::shared_ptr<TreeNode<int>> tree)
+{
+    awaitTeardown();
+    pendingTeardown = destroyTreeAsync(std::move(tree), *ThreadPool<void>::shared());
+}
+
+// Run benchmark suite
+void runBenchmark(const std::string &testName, std::shared_ptr<TreeNode<int>> tree, int target)
+{
+    awaitTeardown();
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+    std::cout << "Target value: " << target << "\n";
+
+    int totalNodes = countNodes(tree);
+    int treeDepth = calculateDepth(tree);
+
+    std::vector<PerformanceMetrics> results;
+
+    // DFS Search
+    DFSSearch dfs;
+    PerformanceMetrics dfsRun{};
+    auto dfsTiming = measure([&]
+                             { dfsRun = dfs.search(tree, target); });
+    results.push_back(measured("DFS", dfsTiming, dfsRun.nodesVisited, dfsRun.found));
+
+    // BFS Search
+    BFSSearch bfs;
+    PerformanceMetrics bfsRun{};
+    auto bfsTiming = measure([&]
+                             { bfsRun = bfs.search(tree, target); });
+    results.push_back(measured("BFS", bfsTiming, bfsRun.nodesVisited, bfsRun.found));
+
+    // Parallel Search with different thread counts. Searchers start their
+    // workers outside the timed region, and the warm-up runs wake them.
+    for (int numThreads : options.threadCounts)
+    {
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+        bool found = false;
+        auto timing = measure([&]
+                              { found = parallelSearch.search(tree, target) != nullptr; });
+
+        std::string name = "Parallel (" + std::to_string(numThreads) + " threads)";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), found));
+    }
+
+    // Level-synchronous and hybrid BFS-then-DFS orders, at the widest thread count
+    for (TraversalOrder order : {TraversalOrder::BreadthFirst, TraversalOrder::Hybrid})
+    {
+        int numThreads = options.threadCounts.back();
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+        parallelSearch.setTraversalOrder(order);
+        bool found = false;
+        auto timing = measure([&]
+                              { found = parallelSearch.search(tree, target) != nullptr; });
+
+        std::string name = (order == TraversalOrder::BreadthFirst ? "Level BFS (" : "Hybrid BFS/DFS (") +
+                           std::to_string(numThreads) + ")";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), found));
+    }
+
+    // Shallowest match with its path, the parallel answer to BFS above, and
+    // the cost of carrying the path along in an ordinary search
+    {
+        int numThreads = options.threadCounts.back();
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+        bool found = false;
+        auto timing = measure([&]
+                              { found = parallelSearch.searchShallowest(tree, target).found(); });
+
+        std::string name = "Shallowest (" + std::to_string(numThreads) + ")";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), found));
+
+        timing = measure([&]
+                         { found = parallelSearch.searchPath(tree, target).found(); });
+        name = "Parallel + path (" + std::to_string(numThreads) + ")";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), found));
+    }
+
+    // Same engine over arena nodes (plain child pointers); copying is not timed
+    auto arena = ArenaTree<int>::fromTree(tree);
+
+    for (int numThreads : options.threadCounts)
+    {
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+        bool found = false;
+        auto timing = measure([&]
+                              { found = parallelSearch.search(arena, target) != nullptr; });
+
+        std::string name = "Arena Parallel (" + std::to_string(numThreads) + ")";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), found));
+    }
+
+    // Same engine over the contiguous preorder layout; flattening is not timed
+    auto flat = FlatTree<int>::fromTree(tree);
+
+    for (int numThreads : options.threadCounts)
+    {
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+        bool found = false;
+        auto timing = measure([&]
+                              { found = parallelSearch.search(flat, target) != FlatTree<int>::npos; });
+
+        std::string name = "Flat Parallel (" + std::to_string(numThreads) + ")";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), found));
+    }
+
+    // Arena and flat again, skipping subtrees whose min/max rule the target
+    // out; summarizing is timed separately, once
+    int summaryThreads = options.threadCounts.back();
+    double summarizeMs = 0.0;
+    {
+        ParallelTreeSearch<int> parallelSearch(summaryThreads, options.splitPolicy);
+
+        auto s0 = std::chrono::steady_clock::now();
+        SubtreeSummary<int> arenaSummary = parallelSearch.summarize(arena);
+        SubtreeSummary<int> flatSummary = parallelSearch.summarize(flat);
+        auto s1 = std::chrono::steady_clock::now();
+        summarizeMs = std::chrono::duration<double, std::milli>(s1 - s0).count();
+
+        bool found = false;
+        auto timing = measure([&]
+                              { found = parallelSearch.search(arena, arenaSummary, target) != nullptr; });
+        std::string name = "Arena Summarized (" + std::to_string(summaryThreads) + ")";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), found));
+
+        timing = measure([&]
+                         { found = parallelSearch.search(flat, flatSummary, target) != FlatTree<int>::npos; });
+        name = "Flat Summarized (" + std::to_string(summaryThreads) + ")";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), found));
+    }
+
+    printResults(results, totalNodes, treeDepth);
+    recordResults(testName, results);
+    std::cout << "FlatTree footprint: " << std::fixed << std::setprecision(2)
+              << flat.memoryBytes() / (1024.0 * 1024.0) << " MB\n";
+    std::cout << "Summarizing arena + flat (" << summaryThreads << " threads): " << std::fixed << std::setprecision(3) << summarizeMs
+              << " ms\n";
+
+    retireTree(std::move(tree));
+}
+
+// Compare build and teardown cost of shared_ptr nodes against arena nodes
+void runConstructionBenchmark(const std::string &testName, int depth, int branchingFactor)
+{
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b)
+    { return std::chrono::duration<double, std::milli>(b - a).count(); };
+
+    awaitTeardown();
+
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+    std::cout << std::string(80, '-') << "\n";
+
+    TreeGenerator generator;
+
+    int sharedNodes = 0;
+    auto t0 = Clock::now();
+    auto tree = generator.generateBalancedTree(depth, branchingFactor, sharedNodes);
+    auto t1 = Clock::now();
+    tree.reset();
+    auto t2 = Clock::now();
+
+    int arenaNodes = 0;
+    size_t arenaBytes = 0;
+    auto t3 = Clock::now();
+    auto arena = std::make_unique<ArenaTree<int>>(size_t(8) << 20);
+    generator.generateBalancedTree(*arena, depth, branchingFactor, arenaNodes);
+    auto t4 = Clock::now();
+    arenaBytes = arena->memoryBytes();
+    arena.reset();
+    auto t5 = Clock::now();
+
+    // Same trees again, built by the parallel generators and freed by
+    // destroyTree on the shared pool
+    int parallelSharedNodes = 0;
+    auto p0 = Clock::now();
+    tree = generator.generateBalancedTreeParallel(depth, branchingFactor, parallelSharedNodes);
+    auto p1 = Clock::now();
+    destroyTree(std::move(tree), *ThreadPool<void>::shared());
+    auto p2 = Clock::now();
+
+    int parallelArenaNodes = 0;
+    auto p3 = Clock::now();
+    arena = std::make_unique<ArenaTree<int>>(size_t(8) << 20);
+    generator.generateBalancedTreeParallel(*arena, depth, branchingFactor, parallelArenaNodes);
+    auto p4 = Clock::now();
+    arena.reset();
+    auto p5 = Clock::now();
+
+    int flatNodes = 0;
+    auto p6 = Clock::now();
+    auto flat = std::make_unique<FlatTree<int>>(generator.generateBalancedFlatTree(depth, branchingFactor, flatNodes));
+    auto p7 = Clock::now();
+    flat.reset();
+    auto p8 = Clock::now();
+
+    auto row = [&](const std::string &name, int nodes, double build, double destroy)
+    {
+        std::cout << std::left << std::setw(25) << name
+                  << std::right << std::setw(15) << nodes
+                  << std::setw(15) << std::fixed << std::setprecision(3) << build
+                  << std::setw(15) << destroy << "\n";
+    };
+
+    std::cout << std::left << std::setw(25) << "Representation"
+              << std::right << std::setw(15) << "Nodes"
+              << std::setw(15) << "Build (ms)"
+              << std::setw(15) << "Free (ms)" << "\n";
+    row("shared_ptr TreeNode", sharedNodes, ms(t0, t1), ms(t1, t2));
+    row("ArenaTree", arenaNodes, ms(t3, t4), ms(t4, t5));
+    size_t workers = ThreadPool<void>::shared()->getThreadCount();
+    std::cout << "Parallel build/free (" << workers << " threads):\n";
+    row("shared_ptr TreeNode", parallelSharedNodes, ms(p0, p1), ms(p1, p2));
+    row("ArenaTree", parallelArenaNodes, ms(p3, p4), ms(p4, p5));
+    row("FlatTree", flatNodes, ms(p6, p7), ms(p7, p8));
+    std::cout << "Arena footprint: " << std::fixed << std::setprecision(2)
+              << arenaBytes / (1024.0 * 1024.0) << " MB\n";
+    std::cout << std::string(80, '=') << "\n\n";
+}
+
+// Push numTasks near-empty tasks through each ThreadPool backend, one
+// enqueue at a time and in batches, and time until the last one has run
+void runPoolBenchmark(const std::string &testName, int numThreads, int numTasks, int batchSize)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+    std::cout << std::string(80, '-') << "\n";
+    std::cout << std::left << std::setw(25) << "Queue"
+              << std::right << std::setw(15) << "Time (ms)"
+              << std::setw(15) << "ns/task" << "\n";
+
+    for (QueueBackend backend : {QueueBackend::Locked, QueueBackend::LockFree})
+    {
+        for (bool batched : {false, true})
+        {
+            ThreadPool<void> pool(numThreads, backend);
+            std::atomic<int> done{0};
+            auto task = [&done]
+            { done.fetch_add(1, std::memory_order_relaxed); };
+
+            auto start = Clock::now();
+            if (batched)
+            {
+                std::vector<std::function<void()>> batch;
+                for (int i = 0; i < numTasks; i += batchSize)
+                {
+                    batch.assign(std::min(batchSize, numTasks - i), task);
+                    pool.enqueueBatch(batch.begin(), batch.end());
+                }
+            }
+            else
+            {
+                for (int i = 0; i < numTasks; ++i)
+                {
+                    pool.enqueue(task);
+                }
+            }
+            while (done.load(std::memory_order_relaxed) < numTasks)
+            {
+                std::this_thread::yield();
+            }
+            auto end = Clock::now();
+
+            double duration = std::chrono::duration<double, std::milli>(end - start).count();
+            std::string name = std::string(backend == QueueBackend::Locked ? "locked" : "lock-free") +
+                               (batched ? ", batch " + std::to_string(batchSize) : ", enqueue");
+            std::cout << std::left << std::setw(25) << name
+                      << std::right << std::setw(15) << std::fixed << std::setprecision(3) << duration
+                      << std::setw(15) << std::setprecision(1) << duration * 1e6 / numTasks << "\n";
+        }
+    }
+    std::cout << std::string(80, '=') << "\n\n";
+}
+
+// Wrap, queue, dequeue and run numTasks tree-sized tasks (a node, a depth
+// and a sink) on one thread, so only the task wrapper's cost is measured
+template <typename Task>
+double timeTaskWrapper(const TreeNode<int> *node, int numTasks, size_t &sink)
+{
+    std::queue<Task> queue;
+    sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numTasks; ++i)
+    {
+        int depth = i & 31;
+        size_t *out = &sink;
+        queue.push(Task([node, depth, out]
+                        { *out += static_cast<size_t>(node->data + depth); }));
+        if (queue.size() >= 256)
+        {
+            while (!queue.empty())
+            {
+                queue.front()();
+                queue.pop();
+            }
+        }
+    }
+    while (!queue.empty())
+    {
+        queue.front()();
+        queue.pop();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Save a FlatTree, map it back and search it in place, against searching
+// the in-memory copy. The mapped tree has just been written, so its pages
+// are normally still cached; this measures setup cost, not disk reads.
+void runFileLoadBenchmark(const std::string &testName, int depth, int branchingFactor, int numThreads)
+{
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b)
+    { return std::chrono::duration<double, std::milli>(b - a).count(); };
+
+    awaitTeardown();
+
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+    std::cout << std::string(80, '-') << "\n";
+
+    TreeGenerator generator;
+    int nodeCounter = 0;
+    FlatTree<int> flat = generator.generateBalancedFlatTree(depth, branchingFactor, nodeCounter);
+    int target = nodeCounter - 1;
+    std::string path = (std::filesystem::temp_directory_path() / "benchmark_tree.flat").string();
+
+    auto t0 = Clock::now();
+    writeFlatTree(flat, path);
+    auto t1 = Clock::now();
+    FlatTree<int> mapped = mapFlatTree<int>(path);
+    auto t2 = Clock::now();
+
+    ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+    auto t3 = Clock::now();
+    size_t mappedIndex = parallelSearch.search(mapped, target);
+    auto t4 = Clock::now();
+    size_t ownedIndex = parallelSearch.search(flat, target);
+    auto t5 = Clock::now();
+
+    std::cout << std::left << std::setw(35) << "Step"
+              << std::right << std::setw(15) << "Time (ms)" << "\n";
+    std::cout << std::left << std::setw(35) << "writeFlatTree"
+              << std::right << std::setw(15) << std::fixed << std::setprecision(3) << ms(t0, t1) << "\n";
+    std::cout << std::left << std::setw(35) << "mapFlatTree"
+              << std::right << std::setw(15) << ms(t1, t2) << "\n";
+    std::cout << std::left << std::setw(35) << "First search, mapped"
+              << std::right << std::setw(15) << ms(t3, t4) << "\n";
+    std::cout << std::left << std::setw(35) << "Search, in memory"
+              << std::right << std::setw(15) << ms(t4, t5) << "\n";
+    std::cout << "Nodes: " << mapped.size() << ", file: " << std::fixed << std::setprecision(2)
+              << mapped.memoryBytes() / (1024.0 * 1024.0) << " MB, results match: "
+              << (mappedIndex == ownedIndex && mappedIndex != FlatTree<int>::npos ? "Yes" : "No") << "\n";
+    std::cout << std::string(80, '=') << "\n\n";
+
+    mapped = FlatTree<int>();
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+}
+
+// Search a streamed tree file while it loads, against loading it all and
+// then searching, for a target near the front and one at the very end
+void runStreamBenchmark(const std::string &testName, int depth, int branchingFactor, int numThreads)
+{
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b)
+    { return std::chrono::duration<double, std::milli>(b - a).count(); };
+
+    awaitTeardown();
+
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+    std::cout << std::string(80, '-') << "\n";
+
+    TreeGenerator generator;
+    int nodeCounter = 0;
+    std::string path = (std::filesystem::temp_directory_path() / "benchmark_tree.stream").string();
+    {
+        FlatTree<int> flat = generator.generateBalancedFlatTree(depth, branchingFactor, nodeCounter);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        writeFlatTreeStream(flat, out);
+    }
+
+    ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+    std::cout << std::left << std::setw(35) << "Method"
+              << std::right << std::setw(12) << "Target"
+              << std::setw(15) << "Time (ms)"
+              << std::setw(15) << "Nodes read" << "\n";
+
+    for (int target : {nodeCounter / 50, nodeCounter - 1})
+    {
+        auto t0 = Clock::now();
+        std::ifstream whole(path, std::ios::binary);
+        FlatTreeStreamReader<int> loader(whole);
+        while (!loader.done())
+        {
+            if (loader.spare() == 0)
+            {
+                loader.grow(STREAM_CHUNK_NODES);
+            }
+            loader.readChunk(STREAM_CHUNK_NODES);
+        }
+        FlatTree<int> loaded = loader.take();
+        size_t loadedIndex = parallelSearch.search(loaded, target);
+        auto t1 = Clock::now();
+
+        std::ifstream streamed(path, std::ios::binary);
+        FlatTreeStreamReader<int> reader(streamed);
+        size_t streamedIndex = parallelSearch.searchStream(reader, target).match;
+        auto t2 = Clock::now();
+
+        std::cout << std::left << std::setw(35) << "Load all, then search"
+                  << std::right << std::setw(12) << target
+                  << std::setw(15) << std::fixed << std::setprecision(3) << ms(t0, t1)
+                  << std::setw(15) << loaded.size() << "\n";
+        std::cout << std::left << std::setw(35) << "searchStream"
+                  << std::right << std::setw(12) << target
+                  << std::setw(15) << ms(t1, t2)
+                  << std::setw(15) << reader.size()
+                  << (streamedIndex == loadedIndex ? "" : "  MISMATCH") << "\n";
+    }
+    std::cout << std::string(80, '=') << "\n\n";
+
+    std::error_code ignored;
+    std::filesystem::remove(path, ignored);
+}
+
+// Exact-match lookups through a prebuilt index against walking the tree
+// every time; the index build is timed separately
+void runIndexBenchmark(const std::string &testName, int depth, int branchingFactor, int numThreads, int numQueries)
+{
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b)
+    { return std::chrono::duration<double, std::milli>(b - a).count(); };
+
+    awaitTeardown();
+
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+    std::cout << std::string(80, '-') << "\n";
+
+    TreeGenerator generator;
+    int nodeCounter = 0;
+    auto tree = generator.generateBalancedTreeParallel(depth, branchingFactor, nodeCounter);
+    FlatTree<int> flat = FlatTree<int>::fromTree(tree);
+
+    std::vector<int> targets(numQueries);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(0, nodeCounter - 1);
+    for (int &t : targets)
+    {
+        t = pick(rng);
+    }
+
+    ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+    std::cout << std::left << std::setw(35) << "Method"
+              << std::right << std::setw(15) << "Build (ms)"
+              << std::setw(15) << "Queries (ms)"
+              << std::setw(15) << "us/query" << "\n";
+    auto row = [&](const std::string &name, double build, double queries)
+    {
+        std::cout << std::left << std::setw(35) << name
+                  << std::right << std::setw(15) << std::fixed << std::setprecision(3) << build
+                  << std::setw(15) << queries
+                  << std::setw(15) << queries * 1000.0 / numQueries << "\n";
+    };
+
+    size_t hits = 0;
+    auto t0 = Clock::now();
+    for (int t : targets)
+    {
+        hits += parallelSearch.search(tree, t) != nullptr;
+    }
+    auto t1 = Clock::now();
+    row("TreeNode search()", 0.0, ms(t0, t1));
+
+    auto t2 = Clock::now();
+    TreeIndex<int> index = parallelSearch.buildIndex(tree);
+    auto t3 = Clock::now();
+    size_t indexedHits = 0;
+    for (int t : targets)
+    {
+        indexedHits += parallelSearch.search(index, t) != nullptr;
+    }
+    auto t4 = Clock::now();
+    row("TreeNode search(TreeIndex)", ms(t2, t3), ms(t3, t4));
+
+    auto t5 = Clock::now();
+    for (int t : targets)
+    {
+        hits += parallelSearch.search(flat, t) != FlatTree<int>::npos;
+    }
+    auto t6 = Clock::now();
+    row("FlatTree search()", 0.0, ms(t5, t6));
+
+    auto t7 = Clock::now();
+    FlatIndex<int> flatIndex = parallelSearch.buildIndex(flat);
+    auto t8 = Clock::now();
+    for (int t : targets)
+    {
+        indexedHits += parallelSearch.search(flatIndex, t) != FlatTree<int>::npos;
+    }
+    auto t9 = Clock::now();
+    row("FlatTree search(FlatIndex)", ms(t7, t8), ms(t8, t9));
+
+    std::cout << "Results match: " << (hits == indexedHits ? "Yes" : "No") << "\n";
+    std::cout << std::string(80, '=') << "\n\n";
+
+    index = TreeIndex<int>();
+    retireTree(std::move(tree));
+}
+
+// Print what each worker did during one not-found and one found search, to
+// tell load imbalance (uneven nodes, idle time) from overhead (queue waits)
+void runStatsBenchmark(const std::string &testName, int depth, int branchingFactor, int numThreads)
+{
+    awaitTeardown();
+
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+
+    TreeGenerator generator;
+    int nodeCounter = 0;
+    auto tree = generator.generateBalancedTreeParallel(depth, branchingFactor, nodeCounter);
+    FlatTree<int> flat = FlatTree<int>::fromTree(tree);
+
+    ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+    auto report = [](const std::string &name, const SearchStats &stats)
+    {
+        auto ms = [](std::chrono::nanoseconds ns)
+        { return ns.count() / 1e6; };
+
+        std::cout << std::string(80, '-') << "\n";
+        std::cout << name << ": " << std::fixed << std::setprecision(3) << ms(stats.elapsed) << " ms";
+        if (stats.timeToFirstMatch)
+        {
+            std::cout << ", first match after " << ms(*stats.timeToFirstMatch) << " ms";
+        }
+        std::cout << ", imbalance " << std::setprecision(2) << stats.imbalance() << "\n";
+        std::cout << std::left << std::setw(10) << "Worker"
+                  << std::right << std::setw(12) << "Nodes"
+                  << std::setw(10) << "Spawned"
+                  << std::setw(10) << "Executed"
+                  << std::setw(10) << "Steals"
+                  << std::setw(14) << "Queued (ms)"
+                  << std::setw(12) << "Idle (ms)" << "\n";
+        auto line = [&](const std::string &label, const WorkerStats &w)
+        {
+            std::cout << std::left << std::setw(10) << label
+                      << std::right << std::setw(12) << w.nodesVisited
+                      << std::setw(10) << w.tasksSpawned
+                      << std::setw(10) << w.tasksExecuted
+                      << std::setw(10) << w.steals
+                      << std::setw(14) << std::setprecision(3) << ms(w.queueWait)
+                      << std::setw(12) << ms(w.idle) << "\n";
+        };
+        for (size_t i = 0; i < stats.workers.size(); ++i)
+        {
+            line(std::to_string(i), stats.workers[i]);
+        }
+        line("Total", stats.total);
+    };
+
+    report("TreeNode, not found", parallelSearch.search(tree, -1, SearchLimits{}).stats);
+    report("TreeNode, found", parallelSearch.search(tree, nodeCounter * 2 / 3, SearchLimits{}).stats);
+    parallelSearch.search(flat, -1);
+    report("FlatTree, not found", parallelSearch.getStats());
+    std::cout << std::string(80, '=') << "\n\n";
+
+    retireTree(std::move(tree));
+}
+
+// Full scans (target absent) with floating workers, with workers pinned
+// across NUMA nodes, and pinned over a copy placed with first-touch, so
+// each node's workers start on memory of their own
+void runNumaBenchmark(const std::string &testName, int depth, int branchingFactor)
+{
+    awaitTeardown();
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+
+    const NumaTopology &topology = NumaTopology::system();
+    std::cout << "NUMA nodes: " << topology.nodeCount() << " (CPUs per node:";
+    for (const auto &cpus : topology.nodeCpus)
+    {
+        std::cout << " " << cpus.size();
+    }
+    std::cout << ")\n";
+    size_t numThreads = std::max<size_t>(2, topology.cpuCount());
+
+    TreeGenerator generator;
+    int nodeCounter = 0;
+    auto tree = generator.generateBalancedTreeParallel(depth, branchingFactor, nodeCounter);
+    int totalNodes = countNodes(tree);
+    int treeDepth = calculateDepth(tree);
+    FlatTree<int> flat = FlatTree<int>::fromTree(tree);
+    auto arena = ArenaTree<int>::fromTree(tree);
+
+    auto p0 = std::chrono::steady_clock::now();
+    NumaFlatTree<int> placedFlat = placeFlatTree(flat, topology);
+    auto placedArena = placeArenaTree(arena, topology);
+    auto p1 = std::chrono::steady_clock::now();
+
+    std::vector<PerformanceMetrics> results;
+    std::vector<std::pair<std::string, size_t>> remoteSteals;
+    std::string suffix = " (" + std::to_string(numThreads) + ")";
+    for (WorkerPinning pinning : {WorkerPinning::None, WorkerPinning::Spread})
+    {
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy, pinning);
+        std::string how = pinning == WorkerPinning::None ? ", unpinned" : ", pinned";
+        bool found = false;
+
+        auto timing = measure([&]
+                              { found = parallelSearch.search(flat, -1) != FlatTree<int>::npos; });
+        results.push_back(measured("Flat" + how + suffix, timing, parallelSearch.getNodesVisited(), found));
+        remoteSteals.push_back({results.back().algorithmName, parallelSearch.getStats().total.remoteSteals});
+
+        timing = measure([&]
+                         { found = parallelSearch.search(arena, -1) != nullptr; });
+        results.push_back(measured("Arena" + how + suffix, timing, parallelSearch.getNodesVisited(), found));
+        remoteSteals.push_back({results.back().algorithmName, parallelSearch.getStats().total.remoteSteals});
+
+        if (pinning == WorkerPinning::None)
+        {
+            continue;
+        }
+        timing = measure([&]
+                         { found = parallelSearch.search(placedFlat, -1) != FlatTree<int>::npos; });
+        results.push_back(measured("Flat placed, pinned" + suffix, timing, parallelSearch.getNodesVisited(), found));
+        remoteSteals.push_back({results.back().algorithmName, parallelSearch.getStats().total.remoteSteals});
+
+        timing = measure([&]
+                         { found = parallelSearch.search(placedArena, -1) != nullptr; });
+        results.push_back(measured("Arena placed, pinned" + suffix, timing, parallelSearch.getNodesVisited(), found));
+        remoteSteals.push_back({results.back().algorithmName, parallelSearch.getStats().total.remoteSteals});
+    }
+
+    printResults(results, totalNodes, treeDepth);
+    recordResults(testName, results);
+    std::cout << "Placing flat + arena copies: " << std::fixed << std::setprecision(3)
+              << std::chrono::duration<double, std::milli>(p1 - p0).count() << " ms, flat slices:";
+    for (const NumaSlice &slice : placedFlat.slices())
+    {
+        std::cout << " [" << slice.begin << ", " << slice.end << ") on node " << slice.node << ";";
+    }
+    std::cout << "\nCross-node steals in the last repetition:\n";
+    for (const auto &[name, steals] : remoteSteals)
+    {
+        std::cout << "  " << std::left << std::setw(25) << name << std::right << std::setw(8) << steals << "\n";
+    }
+
+    retireTree(std::move(tree));
+}
+
+// The generic searcher against LeanTreeSearch (statistics and limit polls
+// compiled out) on full scans: equality search over each layout, a
+// predicate findFirst and a multi-target searchMany
+void runKernelBenchmark(const std::string &testName, int depth, int branchingFactor)
+{
+    awaitTeardown();
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+
+    TreeGenerator generator;
+    int nodeCounter = 0;
+    auto tree = generator.generateBalancedTreeParallel(depth, branchingFactor, nodeCounter);
+    int totalNodes = countNodes(tree);
+    int treeDepth = calculateDepth(tree);
+    FlatTree<int> flat = FlatTree<int>::fromTree(tree);
+    auto arena = ArenaTree<int>::fromTree(tree);
+    std::vector<int> targets = {-1, -2, -3, -4, -5, -6, -7, -8};
+    int numThreads = options.threadCounts.back();
+    std::string suffix = " (" + std::to_string(numThreads) + ")";
+
+    std::vector<PerformanceMetrics> results;
+    auto runKernels = [&](auto &parallelSearch, const std::string &kernel)
+    {
+        bool found = false;
+        auto timing = measure([&]
+                              { found = parallelSearch.search(tree, -1) != nullptr; });
+        results.push_back(measured(kernel + " ==, tree" + suffix, timing, parallelSearch.getNodesVisited(), found));
+
+        timing = measure([&]
+                         { found = parallelSearch.search(arena, -1) != nullptr; });
+        results.push_back(measured(kernel + " ==, arena" + suffix, timing, parallelSearch.getNodesVisited(), found));
+
+        timing = measure([&]
+                         { found = parallelSearch.search(flat, -1) != FlatTree<int>::npos; });
+        results.push_back(measured(kernel + " ==, flat" + suffix, timing, parallelSearch.getNodesVisited(), found));
+
+        timing = measure([&]
+                         { found = parallelSearch.findFirst(arena, [](int v)
+                                                            { return v < 0; }) != nullptr; });
+        results.push_back(measured(kernel + " pred, arena" + suffix, timing, parallelSearch.getNodesVisited(), found));
+
+        timing = measure([&]
+                         {
+            auto hits = parallelSearch.searchMany(arena, std::span<const int>(targets));
+            found = std::any_of(hits.begin(), hits.end(), [](const ArenaTreeNode<int> *h)
+                                { return h != nullptr; }); });
+        results.push_back(measured(kernel + " many, arena" + suffix, timing, parallelSearch.getNodesVisited(), found));
+    };
+
+    ParallelTreeSearch<int> genericSearch(numThreads, options.splitPolicy);
+    runKernels(genericSearch, "Generic");
+    size_t kernels = results.size();
+    LeanTreeSearch<int> leanSearch(numThreads, options.splitPolicy);
+    runKernels(leanSearch, "Lean");
+
+    printResults(results, totalNodes, treeDepth);
+    recordResults(testName, results);
+    std::cout << "Lean over generic, by median:\n";
+    for (size_t k = 0; k < kernels; ++k)
+    {
+        std::cout << "  " << std::left << std::setw(25) << results[k].algorithmName.substr(8) << std::right
+                  << std::setw(8) << std::fixed << std::setprecision(2)
+                  << results[k].executionTimeMs / results[k + kernels].executionTimeMs << "x\n";
+    }
+    std::cout << std::string(80, '=') << "\n\n";
+
+    retireTree(std::move(tree));
+}
+
+void runTaskWrapperBenchmark(const std::string &testName, int numTasks)
+{
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+    std::cout << std::string(80, '-') << "\n";
+    std::cout << std::left << std::setw(25) << "Task type"
+              << std::right << std::setw(15) << "Time (ms)"
+              << std::setw(15) << "ns/task" << "\n";
+
+    TreeNode<int> node(7);
+    size_t functionSum = 0, inlineSum = 0;
+    double functionMs = timeTaskWrapper<std::function<void()>>(&node, numTasks, functionSum);
+    double inlineMs = timeTaskWrapper<InlineTask>(&node, numTasks, inlineSum);
+
+    std::cout << std::left << std::setw(25) << "std::function<void()>"
+              << std::right << std::setw(15) << std::fixed << std::setprecision(3) << functionMs
+              << std::setw(15) << std::setprecision(1) << functionMs * 1e6 / numTasks << "\n";
+    std::cout << std::left << std::setw(25) << "InlineTask"
+              << std::right << std::setw(15) << std::fixed << std::setprecision(3) << inlineMs
+              << std::setw(15) << std::setprecision(1) << inlineMs * 1e6 / numTasks << "\n";
+    std::cout << "Results match: " << (functionSum == inlineSum ? "Yes" : "No") << "\n";
+    std::cout << std::string(80, '=') << "\n\n";
+}
+
+// Run many back-to-back searches on the same tree to expose per-query overhead
+void runRepeatedQueryBenchmark(const std::string &testName, std::shared_ptr<TreeNode<int>> tree, int numQueries)
+{
+    awaitTeardown();
+
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+    std::cout << "Queries: " << numQueries << "\n";
+
+    int totalNodes = countNodes(tree);
+    int treeDepth = calculateDepth(tree);
+
+    // Cycle targets through the whole tree so every query does real work
+    std::vector<int> targets(numQueries);
+    for (int i = 0; i < numQueries; ++i)
+    {
+        targets[i] = (i * 7919) % totalNodes;
+    }
+
+    // Each repetition runs the whole batch of queries
+    std::vector<PerformanceMetrics> results;
+
+    {
+        DFSSearch dfs;
+        size_t nodesVisited = 0;
+        bool allFound = true;
+
+        auto timing = measure([&]
+                              {
+            nodesVisited = 0;
+            allFound = true;
+            for (int target : targets)
+            {
+                auto metrics = dfs.search(tree, target);
+                nodesVisited += metrics.nodesVisited;
+                allFound = allFound && metrics.found;
+            } });
+        results.push_back(measured("DFS", timing, nodesVisited, allFound));
+    }
+
+    for (int numThreads : options.threadCounts)
+    {
+        // Workers are started here, outside the timed region, and reused by every query
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+        size_t nodesVisited = 0;
+        bool allFound = true;
+
+        auto timing = measure([&]
+                              {
+            nodesVisited = 0;
+            allFound = true;
+            for (int target : targets)
+            {
+                auto result = parallelSearch.search(tree, target);
+                nodesVisited += parallelSearch.getNodesVisited();
+                allFound = allFound && result != nullptr;
+            } });
+        std::string name = "Parallel (" + std::to_string(numThreads) + " threads)";
+        results.push_back(measured(name, timing, nodesVisited, allFound));
+    }
+
+    // The same lookups answered by one traversal
+    for (int numThreads : options.threadCounts)
+    {
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+        bool allFound = true;
+
+        auto timing = measure([&]
+                              {
+            auto hits = parallelSearch.searchMany(tree, std::span<const int>(targets));
+            allFound = std::all_of(hits.begin(), hits.end(), [](const auto &h)
+                                   { return h != nullptr; }); });
+        std::string name = "searchMany (" + std::to_string(numThreads) + " threads)";
+        results.push_back(measured(name, timing, parallelSearch.getNodesVisited(), allFound));
+    }
+
+    // The same lookups submitted at once, all in flight on one pool
+    for (int numThreads : options.threadCounts)
+    {
+        ParallelTreeSearch<int> parallelSearch(numThreads, options.splitPolicy);
+        std::vector<std::future<SearchResult<std::shared_ptr<TreeNode<int>>>>> pending;
+        pending.reserve(targets.size());
+        size_t nodesVisited = 0;
+        bool allFound = true;
+
+        auto timing = measure([&]
+                              {
+            nodesVisited = 0;
+            allFound = true;
+            pending.clear();
+            for (int target : targets)
+            {
+                pending.push_back(parallelSearch.searchAsync(tree, target));
+            }
+            for (auto &f : pending)
+            {
+                auto result = f.get();
+                nodesVisited += result.nodesVisited;
+                allFound = allFound && result.match != nullptr;
+            } });
+        std::string name = "searchAsync (" + std::to_string(numThreads) + " threads)";
+        results.push_back(measured(name, timing, nodesVisited, allFound));
+    }
+
+    // Two request threads, each with its own searcher, splitting the queries:
+    // private pools (2x the hardware threads) vs one process-wide pool.
+    // Searchers are created per repetition, as a request thread would.
+    for (bool sharePool : {false, true})
+    {
+        size_t hw = ThreadPool<void>::shared()->getThreadCount();
+        std::atomic<size_t> nodesVisited{0};
+        std::atomic<bool> allFound{true};
+
+        auto timing = measure([&]
+                              {
+            nodesVisited = 0;
+            allFound = true;
+            std::vector<std::thread> clients;
+            for (int c = 0; c < 2; ++c)
+            {
+                clients.emplace_back([&, c]
+                                     {
+                    auto searcher = sharePool ? std::make_unique<ParallelTreeSearch<int>>(ThreadPool<void>::shared(), options.splitPolicy)
+                                              : std::make_unique<ParallelTreeSearch<int>>(hw, options.splitPolicy);
+                    for (size_t i = c; i < targets.size(); i += 2)
+                    {
+                        auto result = searcher->search(tree, targets[i]);
+                        nodesVisited += searcher->getNodesVisited();
+                        if (!result)
+                            allFound = false;
+                    } });
+            }
+            for (auto &client : clients)
+            {
+                client.join();
+            } });
+        std::string name = sharePool ? "2 searchers, shared pool" : "2 searchers, own pools";
+        results.push_back(measured(name, timing, nodesVisited.load(), allFound.load()));
+    }
+
+    printResults(results, totalNodes, treeDepth);
+    recordResults(testName, results);
+
+    std::cout << "Per-query latency (median batch):\n";
+    for (const auto &result : results)
+    {
+        std::cout << "  " << std::left << std::setw(25) << result.algorithmName
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+                  << (result.executionTimeMs * 1000.0 / numQueries) << " us\n";
+    }
+}
+
+// Thread counts for the scalability sweep: 1, 2, 4, ... up to the hardware
+// thread count, which is always included
+std::vector<int> sweepThreadCounts()
+{
+    int hw = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> counts;
+    for (int t = 1; t < hw; t *= 2)
+    {
+        counts.push_back(t);
+    }
+    counts.push_back(hw);
+    return counts;
+}
+
+struct SweepTarget
+{
+    std::string position;
+    int value;
+};
+
+// Targets at fixed fractions of the DFS order, at both ends of the middle
+// BFS level, and one that isn't in the tree
+std::vector<SweepTarget> sweepTargets(const std::shared_ptr<TreeNode<int>> &root)
+{
+    std::vector<int> preorder;
+    std::vector<const TreeNode<int> *> stack{root.get()};
+    while (!stack.empty())
+    {
+        const TreeNode<int> *node = stack.back();
+        stack.pop_back();
+        preorder.push_back(node->data);
+        for (size_t i = node->children.size(); i-- > 0;)
+        {
+            stack.push_back(node->children[i].get());
+        }
+    }
+
+    std::vector<const TreeNode<int> *> level{root.get()};
+    for (int d = calculateDepth(root) / 2; d > 0; --d)
+    {
+        std::vector<const TreeNode<int> *> next;
+        for (const auto *node : level)
+        {
+            for (const auto &child : node->children)
+            {
+                next.push_back(child.get());
+            }
+        }
+        level = std::move(next);
+    }
+
+    size_t n = preorder.size();
+    return {{"DFS early", preorder[n / 10]},
+            {"DFS middle", preorder[n / 2]},
+            {"DFS late", preorder[n - 1 - n / 10]},
+            {"BFS left", level.front()->data},
+            {"BFS right", level.back()->data},
+            {"Absent", -1}};
+}
+
+// Strong scaling of the parallel search over shared_ptr nodes: every tree
+// shape and target position at 1..hardware_concurrency threads, with
+// speedup and efficiency (speedup / threads) against sequential DFS
+void runScalabilitySweep(const std::string &testName, TreeGenerator &generator)
+{
+    awaitTeardown();
+    std::cout << "\n"
+              << std::string(80, '=') << "\n";
+    std::cout << "RUNNING: " << testName << "\n";
+
+    std::vector<int> threadCounts = sweepThreadCounts();
+    std::cout << "Threads:";
+    for (int t : threadCounts)
+    {
+        std::cout << " " << t;
+    }
+    std::cout << " (hardware threads: " << std::thread::hardware_concurrency() << ")\n";
+    std::cout << "Repetitions: " << options.repetitions << " (after " << options.warmups << " warm-up)\n";
+
+    struct Shape
+    {
+        std::string name;
+        std::function<std::shared_ptr<TreeNode<int>>()> build;
+    };
+    std::vector<Shape> shapes = {
+        {"Balanced (depth=9, branching=4)", [&]
+         { int c = 0; return generator.generateBalancedTree(9, 4, c); }},
+        {"Random (300K nodes, 1-6 children)", [&]
+         { int c = 0; return generator.generateRandomBushyTree(300000, 1, 6, c); }},
+        {"Skewed (depth=4000)", [&]
+         { int c = 0; return generator.generateSkewedTree(4000, c); }},
+    };
+
+    // Searchers are started once and reused by every shape
+    std::vector<std::unique_ptr<ParallelTreeSearch<int>>> searchers;
+    for (int t : threadCounts)
+    {
+        searchers.push_back(std::make_unique<ParallelTreeSearch<int>>(t, options.splitPolicy));
+    }
+
+    const int width = 22 + 10 + 9 * static_cast<int>(threadCounts.size()) + 8;
+    for (const auto &shape : shapes)
+    {
+        auto tree = shape.build();
+        std::cout << "\n"
+                  << shape.name << ": " << countNodes(tree) << " nodes, depth " << calculateDepth(tree) << "\n";
+
+        // Speedups and efficiencies, one row per target position
+        std::vector<std::string> positions;
+        std::vector<double> dfsMs;
+        std::vector<std::vector<double>> speedups;
+        for (const auto &target : sweepTargets(tree))
+        {
+            std::vector<PerformanceMetrics> results;
+            DFSSearch dfs;
+            PerformanceMetrics dfsRun{};
+            auto dfsTiming = measure([&]
+                                     { dfsRun = dfs.search(tree, target.value); });
+            results.push_back(measured("DFS", dfsTiming, dfsRun.nodesVisited, dfsRun.found));
+
+            std::vector<double> row;
+            for (size_t k = 0; k < threadCounts.size(); ++k)
+            {
+                auto &searcher = *searchers[k];
+                bool found = false;
+                auto timing = measure([&]
+                                      { found = searcher.search(tree, target.value) != nullptr; });
+                std::string name = "Parallel (" + std::to_string(threadCounts[k]) + " threads)";
+                results.push_back(measured(name, timing, searcher.getNodesVisited(), found));
+                row.push_back(dfsTiming.medianMs / timing.medianMs);
+            }
+
+            recordResults(testName + " / " + shape.name + " / " + target.position, results);
+            positions.push_back(target.position + " (" + std::to_string(target.value) + ")");
+            dfsMs.push_back(dfsTiming.medianMs);
+            speedups.push_back(std::move(row));
+        }
+
+        for (bool efficiency : {false, true})
+        {
+            std::cout << std::string(width, '-') << "\n";
+            std::cout << std::left << std::setw(22) << (efficiency ? "Efficiency" : "Speedup vs DFS")
+                      << std::right << std::setw(10) << "DFS (ms)";
+            for (int t : threadCounts)
+            {
+                std::cout << std::setw(9) << ("T=" + std::to_string(t));
+            }
+            std::cout << std::setw(8) << "Best" << "\n";
+            std::cout << std::string(width, '-') << "\n";
+
+            for (size_t r = 0; r < positions.size(); ++r)
+            {
+                std::cout << std::left << std::setw(22) << positions[r]
+                          << std::right << std::setw(10) << std::fixed << std::setprecision(3) << dfsMs[r];
+                size_t best = 0;
+                for (size_t k = 0; k < threadCounts.size(); ++k)
+                {
+                    double s = speedups[r][k];
+                    if (efficiency)
+                    {
+                        std::cout << std::setw(8) << std::setprecision(0) << 100.0 * s / threadCounts[k] << "%";
+                    }
+                    else
+                    {
+                        std::cout << std::setw(8) << std::setprecision(2) << s << "x";
+                    }
+                    if (s > speedups[r][best])
+                    {
+                        best = k;
+                    }
+                }
+                // Thread count with the highest speedup; "-" if none beats DFS
+                std::cout << std::setw(8) << (speedups[r][best] > 1.0 ? "T=" + std::to_string(threadCounts[best]) : std::string("-"))
+                          << "\n";
+            }
+        }
+        std::cout << std::string(width, '-') << "\n";
+
+        retireTree(std::move(tree));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        if (!parseOptions(argc, argv, options))
+        {
+            return 0;
+        }
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "benchmark: " << e.what() << "\n";
+        usage(std::cerr);
+        return 2;
+    }
+
+    TreeGenerator generator;
+
+    std::cout << "\n";
     std::cout << "==============================================================================\n";
     std::cout << "|          TREE SEARCH ALGORITHM PERFORMANCE BENCHMARK SUITE                 |\n";
     std::cout << "==============================================================================\n";
+    std::cout << "FlatTree scan kernel: " << simdScanBackend() << "\n";
 
-    std::cout << "\n>>> SECTION 1: Threading Overhead Analysis <<<\n";
+    if (options.wantsAny({1, 2}))
+    {
+        std::cout << "\n>>> SECTION 1: Threading Overhead Analysis <<<\n";
+    }
 
     // Test 1: Small Tree - Threading overhead dominates
+    if (options.wants(1))
     {
         int nodeCounter = 0;
         auto tree = generator.generateBalancedTree(4, 3, nodeCounter);
         int target = nodeCounter / 2;
-        runBenchmark("Test 1: Small Tree (depth=4, branching=3) - Threading Overhead", tree, target);
+        runBenchmark("Test 1: Small Tree (depth=4, branching=3) - Threading Overhead", std::move(tree), target);
     }
 
     // Test 2: Medium Tree - Transition point
+    if (options.wants(2))
     {
         int nodeCounter = 0;
         auto tree = generator.generateBalancedTree(6, 4, nodeCounter);
         int target = nodeCounter - 100;
-        runBenchmark("Test 2: Medium Tree (depth=6, branching=4) - Transition Point", tree, target);
+        runBenchmark("Test 2: Medium Tree (depth=6, branching=4) - Transition Point", std::move(tree), target);
     }
 
-    std::cout << "\n>>> SECTION 2: Large Trees - Parallel Advantage <<<\n";
+    if (options.wantsAny({3, 4, 5}))
+    {
+        std::cout << "\n>>> SECTION 2: Large Trees - Parallel Advantage <<<\n";
+    }
 
     // Test 3: Large Balanced Tree
+    if (options.wants(3))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(9, 4, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(9, 4, nodeCounter);
         int target = nodeCounter - 5000;
-        runBenchmark("Test 3: Large Balanced Tree (depth=9, branching=4) ~262K nodes", tree, target);
+        runBenchmark("Test 3: Large Balanced Tree (depth=9, branching=4) ~262K nodes", std::move(tree), target);
     }
 
     // Test 4: Very Large Balanced Tree
+    if (options.wants(4))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(10, 4, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(10, 4, nodeCounter);
         int target = nodeCounter - 10000;
-        runBenchmark("Test 4: Very Large Tree (depth=10, branching=4) ~1M nodes", tree, target);
+        runBenchmark("Test 4: Very Large Tree (depth=10, branching=4) ~1M nodes", std::move(tree), target);
     }
 
     // Test 5: Massive Wide Tree
+    if (options.wants(5))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(8, 8, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(8, 8, nodeCounter);
         int target = nodeCounter - 20000;
-        runBenchmark("Test 5: Massive Wide Tree (depth=8, branching=8) ~16M nodes", tree, target);
+        runBenchmark("Test 5: Massive Wide Tree (depth=8, branching=8) ~16M nodes", std::move(tree), target);
     }
 
-    std::cout << "\n>>> SECTION 3: Worst Case Scenarios - DFS Must Traverse Entire Tree <<<\n";
+    if (options.wantsAny({6, 7, 8, 9, 10, 11, 12}))
+    {
+        std::cout << "\n>>> SECTION 3: Worst Case Scenarios - DFS Must Traverse Entire Tree <<<\n";
+    }
 
     // Test 6: DFS Nightmare - Target at Rightmost Leaf
+    if (options.wants(6))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(10, 3, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(10, 3, nodeCounter);
         int target = nodeCounter - 1; // Last node DFS reaches
-        runBenchmark("Test 6: DFS WORST - Rightmost Leaf (depth=10, branching=3) ~88K nodes", tree, target);
+        runBenchmark("Test 6: DFS WORST - Rightmost Leaf (depth=10, branching=3) ~88K nodes", std::move(tree), target);
     }
 
     // Test 7: DFS Nightmare - Large Tree, Rightmost Node
+    if (options.wants(7))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(10, 4, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(10, 4, nodeCounter);
         int target = nodeCounter - 1; // Last node in DFS order
-        runBenchmark("Test 7: DFS WORST - Large Tree Rightmost (depth=10, branching=4) ~1M nodes", tree, target);
+        runBenchmark("Test 7: DFS WORST - Large Tree Rightmost (depth=10, branching=4) ~1M nodes", std::move(tree), target);
     }
 
     // Test 8: DFS Nightmare - Massive Tree, Target at End
+    if (options.wants(8))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(9, 5, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(9, 5, nodeCounter);
         int target = nodeCounter - 1; // Absolute last node
-        runBenchmark("Test 8: DFS WORST - Massive Rightmost (depth=9, branching=5) ~1.9M nodes", tree, target);
+        runBenchmark("Test 8: DFS WORST - Massive Rightmost (depth=9, branching=5) ~1.9M nodes", std::move(tree), target);
     }
 
     // Test 9: Target Not Found - Must Search Every Node
+    if (options.wants(9))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(9, 5, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(9, 5, nodeCounter);
         int target = -1; // Doesn't exist
-        runBenchmark("Test 9: WORST CASE - Target Not Found (depth=9, branching=5) ~1.9M nodes", tree, target);
+        runBenchmark("Test 9: WORST CASE - Target Not Found (depth=9, branching=5) ~1.9M nodes", std::move(tree), target);
     }
 
     // Test 10: Skewed Tree - Worst for Parallel
+    if (options.wants(10))
     {
         int nodeCounter = 0;
         auto tree = generator.generateSkewedTree(2000, nodeCounter);
         int target = nodeCounter - 1; // At the end of long chain
-        runBenchmark("Test 10: WORST CASE - Skewed Tree (depth=2000, unbalanced)", tree, target);
+        runBenchmark("Test 10: WORST CASE - Skewed Tree (depth=2000, unbalanced)", std::move(tree), target);
     }
 
     // Test 11: Deep Tree - Target at Bottom Right
+    if (options.wants(11))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(11, 3, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(11, 3, nodeCounter);
         int target = nodeCounter - 1; // Deepest rightmost node
-        runBenchmark("Test 11: DFS WORST - Deep Rightmost (depth=11, branching=3) ~177K nodes", tree, target);
+        runBenchmark("Test 11: DFS WORST - Deep Rightmost (depth=11, branching=3) ~177K nodes", std::move(tree), target);
     }
 
     // Test 12: Wide Tree - Target at Far Right
+    if (options.wants(12))
     {
         int nodeCounter = 0;
-        auto tree = generator.generateBalancedTree(7, 8, nodeCounter);
+        auto tree = generator.generateBalancedTreeParallel(7, 8, nodeCounter);
         int target = nodeCounter - 1; // Far right in wide tree
-        runBenchmark("Test 12: DFS WORST - Wide Rightmost (depth=7, branching=8) ~2.3M nodes", tree, target);
+        runBenchmark("Test 12: DFS WORST - Wide Rightmost (depth=7, branching=8) ~2.3M nodes", std::move(tree), target);
+    }
+
+    if (options.wantsAny({13, 14}))
+    {
+        std::cout << "\n>>> SECTION 4: Per-Query Overhead - Back-to-Back Searches <<<\n";
+    }
+
+    // Test 13: Many queries against a small tree - worker startup must not be paid per query
+    if (options.wants(13))
+    {
+        int nodeCounter = 0;
+        auto tree = generator.generateBalancedTree(4, 3, nodeCounter);
+        runRepeatedQueryBenchmark("Test 13: Repeated Queries - Small Tree (depth=4, branching=3) x10000", tree, 10000);
+    }
+
+    // Test 14: Many queries against a medium tree
+    if (options.wants(14))
+    {
+        int nodeCounter = 0;
+        auto tree = generator.generateBalancedTree(6, 4, nodeCounter);
+        runRepeatedQueryBenchmark("Test 14: Repeated Queries - Medium Tree (depth=6, branching=4) x2000", tree, 2000);
+    }
+
+    if (options.wantsAny({15, 16, 17}))
+    {
+        std::cout << "\n>>> SECTION 5: Tree Construction and Teardown <<<\n";
+    }
+
+    if (options.wants(15))
+    {
+        runConstructionBenchmark("Test 15: Build/Free - Very Large Tree (depth=10, branching=4) ~1M nodes", 10, 4);
+    }
+    if (options.wants(16))
+    {
+        runConstructionBenchmark("Test 16: Build/Free - Massive Wide Tree (depth=8, branching=8) ~16M nodes", 8, 8);
+    }
+    if (options.wants(17))
+    {
+        runConstructionBenchmark("Test 17: Build/Free - Wide Tree (depth=7, branching=8) ~2.3M nodes", 7, 8);
+    }
+
+    if (options.wantsAny({18, 19}))
+    {
+        std::cout << "\n>>> SECTION 6: Thread Pool Task Throughput <<<\n";
+    }
+
+    if (options.wants(18))
+    {
+        runPoolBenchmark("Test 18: Tiny Tasks - 4 workers x1M tasks", 4, 1000000, 64);
+    }
+    if (options.wants(19))
+    {
+        runTaskWrapperBenchmark("Test 19: Task Wrapper - node+depth capture, single thread x1M", 1000000);
+    }
+
+    if (options.wantsAny({20, 21}))
+    {
+        std::cout << "\n>>> SECTION 7: Loading Trees From Disk <<<\n";
+    }
+
+    if (options.wants(20))
+    {
+        runFileLoadBenchmark("Test 20: Map and Search - Massive Wide Tree (depth=8, branching=8) ~16M nodes", 8, 8, 4);
+    }
+    if (options.wants(21))
+    {
+        runStreamBenchmark("Test 21: Search While Loading - Massive Wide Tree (depth=8, branching=8) ~16M nodes", 8, 8, 4);
+    }
+
+    if (options.wants(22))
+    {
+        std::cout << "\n>>> SECTION 8: Indexed Exact-Match Lookups <<<\n";
+    }
+
+    if (options.wants(22))
+    {
+        runIndexBenchmark("Test 22: Indexed Lookups - Wide Tree (depth=7, branching=8) ~2.3M nodes x100", 7, 8, 4, 100);
+    }
+
+    if (options.wants(23))
+    {
+        std::cout << "\n>>> SECTION 9: Per-Worker Statistics <<<\n";
+    }
+
+    if (options.wants(23))
+    {
+        runStatsBenchmark("Test 23: Worker Stats - Very Large Tree (depth=10, branching=4) ~1M nodes, 4 threads", 10, 4, 4);
+    }
+
+    if (options.wants(24))
+    {
+        std::cout << "\n>>> SECTION 10: Scalability Sweep <<<\n";
+        runScalabilitySweep("Test 24: Scalability Sweep - thread count x target position x tree shape", generator);
+    }
+
+    if (options.wants(25))
+    {
+        std::cout << "\n>>> SECTION 11: NUMA Placement <<<\n";
+        runNumaBenchmark("Test 25: NUMA Placement - Very Large Tree (depth=10, branching=4) ~1M nodes, not found", 10, 4);
     }
 
+    if (options.wants(26))
+    {
+        std::cout << "\n>>> SECTION 12: Specialized Kernels <<<\n";
+        runKernelBenchmark("Test 26: Generic vs Lean Kernels - Very Large Tree (depth=10, branching=4) ~1M nodes, not found", 10, 4);
+    }
+
+    awaitTeardown();
+
+    if (!options.jsonPath.empty())
+    {
+        writeJsonReport(options.jsonPath);
+        std::cout << "Wrote " << reportRows.size() << " results to " << options.jsonPath << "\n";
+    }
+    if (!options.csvPath.empty())
+    {
+        writeCsvReport(options.csvPath);
+        std::cout << "Wrote " << reportRows.size() << " results to " << options.csvPath << "\n";
+    }
     return 0;
 }
\ No newline at end of file
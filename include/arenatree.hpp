@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "nodearena.hpp"
+#include "treenode.hpp"
+
+template <typename T>
+class ArenaTree;
+
+// Node whose storage and child arrays live in an ArenaTree's arena. Child
+// links are plain pointers: there is no refcount to touch on any visit, and
+// the whole tree is freed in one go with its arena. There is no per-node
+// visited flag; id() indexes external state such as VisitEpochs.
+template <typename T>
+class ArenaTreeNode
+{
+public:
+    T data;
+
+private:
+    std::uint32_t nodeId;
+    std::uint32_t count = 0;
+    std::uint32_t capacity = 0;
+    ArenaTreeNode **links = nullptr;
+
+    friend class ArenaTree<T>;
+
+public:
+    ArenaTreeNode(const T &value, std::uint32_t id) : data(value), nodeId(id) {}
+
+    ArenaTreeNode(const ArenaTreeNode &) = delete;
+    ArenaTreeNode &operator=(const ArenaTreeNode &) = delete;
+
+    // Dense: 0 .. ArenaTree::size() - 1, in creation order unless the
+    // builder numbered nodes itself (see ArenaTree::Shard)
+    size_t id() const { return nodeId; }
+    size_t childCount() const { return count; }
+    ArenaTreeNode *child(size_t i) const { return links[i]; }
+    bool isLeaf() const { return count == 0; }
+
+    ArenaTreeNode *const *begin() const { return links; }
+    ArenaTreeNode *const *end() const { return links + count; }
+};
+
+template <typename T>
+class ArenaTree
+{
+private:
+    NodeArena arena;
+    // Arenas of adopted shards, freed with the tree
+    std::vector<NodeArena> shardArenas;
+    ArenaTreeNode<T> *rootNode = nullptr;
+    size_t nodeCount = 0;
+
+    static ArenaTreeNode<T> *makeNode(NodeArena &into, const T &value, size_t id)
+    {
+        if (id >= std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("ArenaTree node count exceeds id range");
+        return into.create<ArenaTreeNode<T>>(value, static_cast<std::uint32_t>(id));
+    }
+
+    static void growChildren(NodeArena &into, ArenaTreeNode<T> *parent, size_t n)
+    {
+        if (n <= parent->capacity)
+            return;
+        auto **next = into.allocateArray<ArenaTreeNode<T> *>(n);
+        if (parent->count)
+            std::memcpy(next, parent->links, parent->count * sizeof(ArenaTreeNode<T> *));
+        // The old array stays in the arena until the tree is released
+        parent->links = next;
+        parent->capacity = static_cast<std::uint32_t>(n);
+    }
+
+    static void linkChild(NodeArena &into, ArenaTreeNode<T> *parent, ArenaTreeNode<T> *child)
+    {
+        if (!child)
+            throw std::invalid_argument("ArenaTree::addChild with null child");
+        if (parent->count == parent->capacity)
+            growChildren(into, parent, parent->capacity ? parent->capacity * 2 : 2);
+        parent->links[parent->count++] = child;
+    }
+
+public:
+    // A subtree built in its own arena, so several can be built at once on
+    // different threads, then handed to the tree with adopt(). Its nodes are
+    // numbered firstId, firstId + 1, ... in creation order; the builder picks
+    // firstId so ids stay dense across the whole tree.
+    class Shard
+    {
+    private:
+        NodeArena arena;
+        size_t nextId;
+        size_t nodes = 0;
+
+        friend class ArenaTree;
+
+    public:
+        explicit Shard(size_t firstId, size_t blockBytes = 1 << 20) : arena(blockBytes), nextId(firstId) {}
+
+        ArenaTreeNode<T> *createNode(const T &value)
+        {
+            ++nodes;
+            return makeNode(arena, value, nextId++);
+        }
+
+        void reserveChildren(ArenaTreeNode<T> *parent, size_t n) { growChildren(arena, parent, n); }
+        void addChild(ArenaTreeNode<T> *parent, ArenaTreeNode<T> *child) { linkChild(arena, parent, child); }
+
+        size_t size() const { return nodes; }
+    };
+
+    explicit ArenaTree(size_t blockBytes = 1 << 20) : arena(blockBytes) {}
+
+    ArenaTree(ArenaTree &&other) noexcept
+        : arena(std::move(other.arena)), shardArenas(std::move(other.shardArenas)), rootNode(other.rootNode),
+          nodeCount(other.nodeCount)
+    {
+        other.rootNode = nullptr;
+        other.nodeCount = 0;
+    }
+
+    ArenaTree &operator=(ArenaTree &&) = delete;
+
+    ArenaTreeNode<T> *createNode(const T &value)
+    {
+        return makeNode(arena, value, nodeCount++);
+    }
+
+    // For trees assembled from shards: the caller numbers the nodes it
+    // creates here too, and must keep ids dense
+    ArenaTreeNode<T> *createNode(const T &value, size_t id)
+    {
+        ++nodeCount;
+        return makeNode(arena, value, id);
+    }
+
+    // Take ownership of a finished shard's nodes; link its root with addChild()
+    void adopt(Shard &&shard)
+    {
+        nodeCount += shard.nodes;
+        shardArenas.push_back(std::move(shard.arena));
+        shard.nodes = 0;
+    }
+
+    // Size a node's child array exactly when the fan-out is known up front
+    void reserveChildren(ArenaTreeNode<T> *parent, size_t n)
+    {
+        growChildren(arena, parent, n);
+    }
+
+    void addChild(ArenaTreeNode<T> *parent, ArenaTreeNode<T> *child)
+    {
+        linkChild(arena, parent, child);
+    }
+
+    void setRoot(ArenaTreeNode<T> *node) { rootNode = node; }
+    ArenaTreeNode<T> *root() const { return rootNode; }
+
+    size_t size() const { return nodeCount; }
+    size_t memoryBytes() const
+    {
+        size_t bytes = arena.bytesReserved();
+        for (const auto &a : shardArenas)
+            bytes += a.bytesReserved();
+        return bytes;
+    }
+
+    // Copy a pointer tree into a fresh arena (iteratively)
+    static ArenaTree fromTree(const std::shared_ptr<TreeNode<T>> &root)
+    {
+        ArenaTree tree;
+        if (!root)
+            return tree;
+
+        std::vector<std::pair<const TreeNode<T> *, ArenaTreeNode<T> *>> stack;
+        tree.setRoot(tree.createNode(root->data));
+        stack.push_back({root.get(), tree.root()});
+
+        while (!stack.empty())
+        {
+            auto [src, dst] = stack.back();
+            stack.pop_back();
+            tree.reserveChildren(dst, src->children.size());
+            for (const auto &c : src->children)
+            {
+                if (!c)
+                    continue;
+                ArenaTreeNode<T> *copy = tree.createNode(c->data);
+                tree.addChild(dst, copy);
+                stack.push_back({c.get(), copy});
+            }
+        }
+        return tree;
+    }
+};
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+#include "treenode.hpp"
+
+// Contiguous, structure-of-arrays tree stored in DFS preorder.
+//
+// Node i's subtree is the index range [i, i + subtreeSize(i)), its first child
+// (if any) is i + 1 and its next sibling is i + subtreeSize(i). A search over
+// any subtree is therefore a scan over a contiguous slice of data().
+//
+// The arrays are either owned or a read-only view of memory kept alive by a
+// backing handle (see fromView and flattreefile.hpp's mapFlatTree); every
+// accessor, and so every search, works the same on both.
+//
+// Ancestors aren't stored, but follow from the index ranges: pathTo(i)
+// descends from the root into whichever child's range holds i. For many
+// ancestor queries, buildParents() adds a parent index per node, which
+// makes parent(), depth() and pathTo() O(depth).
+template <typename T>
+class FlatTree
+{
+public:
+    using Index = std::uint32_t;
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+private:
+    std::vector<T> values;
+    std::vector<Index> subtreeSizes;
+    std::vector<Index> childCounts;
+    // Optional (buildParents); always owned, even by a view
+    std::vector<Index> parents;
+
+    static constexpr Index NoParent = std::numeric_limits<Index>::max();
+
+    // What the accessors read: the vectors above, or a view into backing
+    const T *valueData = nullptr;
+    const Index *sizeData = nullptr;
+    const Index *countData = nullptr;
+    size_t count = 0;
+    std::shared_ptr<const void> backing;
+    size_t backingBytes = 0;
+
+    void bindOwned()
+    {
+        valueData = values.data();
+        sizeData = subtreeSizes.data();
+        countData = childCounts.data();
+        count = values.size();
+    }
+
+    void bindFrom(const FlatTree &other)
+    {
+        backing = other.backing;
+        backingBytes = other.backingBytes;
+        if (backing)
+        {
+            valueData = other.valueData;
+            sizeData = other.sizeData;
+            countData = other.countData;
+            count = other.count;
+        }
+        else
+        {
+            bindOwned();
+        }
+    }
+
+    // Leave a moved-from tree empty
+    void reset() noexcept
+    {
+        values.clear();
+        subtreeSizes.clear();
+        childCounts.clear();
+        parents.clear();
+        backing.reset();
+        backingBytes = 0;
+        bindOwned();
+    }
+
+public:
+    FlatTree() = default;
+
+    FlatTree(const FlatTree &other)
+        : values(other.values), subtreeSizes(other.subtreeSizes), childCounts(other.childCounts), parents(other.parents)
+    {
+        bindFrom(other);
+    }
+
+    FlatTree(FlatTree &&other) noexcept
+        : values(std::move(other.values)), subtreeSizes(std::move(other.subtreeSizes)),
+          childCounts(std::move(other.childCounts)), parents(std::move(other.parents))
+    {
+        bindFrom(other);
+        other.reset();
+    }
+
+    FlatTree &operator=(const FlatTree &other)
+    {
+        if (this != &other)
+        {
+            values = other.values;
+            subtreeSizes = other.subtreeSizes;
+            childCounts = other.childCounts;
+            parents = other.parents;
+            bindFrom(other);
+        }
+        return *this;
+    }
+
+    FlatTree &operator=(FlatTree &&other) noexcept
+    {
+        if (this != &other)
+        {
+            values = std::move(other.values);
+            subtreeSizes = std::move(other.subtreeSizes);
+            childCounts = std::move(other.childCounts);
+            parents = std::move(other.parents);
+            bindFrom(other);
+            other.reset();
+        }
+        return *this;
+    }
+
+    // Flatten a pointer tree (iteratively, so depth is not limited by the call stack)
+    static FlatTree fromTree(const std::shared_ptr<TreeNode<T>> &root);
+
+    // Take arrays already laid out in preorder, e.g. filled in parallel by a
+    // generator that knows every subtree's size. Only the lengths are checked.
+    static FlatTree fromArrays(std::vector<T> values, std::vector<Index> subtreeSizes, std::vector<Index> childCounts)
+    {
+        if (subtreeSizes.size() != values.size() || childCounts.size() != values.size())
+        {
+            throw std::invalid_argument("FlatTree::fromArrays with mismatched array lengths");
+        }
+        if (values.size() >= std::numeric_limits<Index>::max())
+        {
+            throw std::length_error("FlatTree node count exceeds index range");
+        }
+        FlatTree tree;
+        tree.values = std::move(values);
+        tree.subtreeSizes = std::move(subtreeSizes);
+        tree.childCounts = std::move(childCounts);
+        tree.bindOwned();
+        return tree;
+    }
+
+    // Read-only view of preorder arrays owned by someone else, e.g. a mapped
+    // file. backing is held for as long as any copy of the tree exists;
+    // backingBytes is what memoryBytes() reports. Nothing is copied or checked.
+    static FlatTree fromView(const T *values, const Index *subtreeSizes, const Index *childCounts, size_t n,
+                             std::shared_ptr<const void> backing, size_t backingBytes = 0)
+    {
+        if (n >= std::numeric_limits<Index>::max())
+        {
+            throw std::length_error("FlatTree node count exceeds index range");
+        }
+        FlatTree tree;
+        tree.valueData = values;
+        tree.sizeData = subtreeSizes;
+        tree.countData = childCounts;
+        tree.count = n;
+        tree.backing = std::move(backing);
+        tree.backingBytes = backingBytes;
+        return tree;
+    }
+
+    // True when the arrays are a view (fromView) rather than owned
+    bool isView() const { return backing != nullptr; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const T &value(size_t i) const { return valueData[i]; }
+    Index subtreeSize(size_t i) const { return sizeData[i]; }
+    Index childCount(size_t i) const { return countData[i]; }
+    bool isLeaf(size_t i) const { return countData[i] == 0; }
+
+    size_t firstChild(size_t i) const { return countData[i] ? i + 1 : npos; }
+    size_t subtreeEnd(size_t i) const { return i + sizeData[i]; }
+
+    // Next sibling of i, given the end of i's parent's subtree
+    size_t nextSibling(size_t i, size_t parentEnd) const
+    {
+        size_t next = i + sizeData[i];
+        return next < parentEnd ? next : npos;
+    }
+
+    const T *data() const { return valueData; }
+    const Index *subtreeSizeData() const { return sizeData; }
+    const Index *childCountData() const { return countData; }
+
+    // Record every node's parent: one pass, sizeof(Index) per node
+    void buildParents()
+    {
+        parents.assign(count, NoParent);
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t c = firstChild(i), end = subtreeEnd(i); c != npos; c = nextSibling(c, end))
+            {
+                parents[c] = static_cast<Index>(i);
+            }
+        }
+    }
+
+    bool hasParents() const { return count != 0 && parents.size() == count; }
+
+    // Parent of i, or npos for the root
+    size_t parent(size_t i) const
+    {
+        if (!hasParents())
+        {
+            std::vector<size_t> path = pathTo(i);
+            return path.size() < 2 ? npos : path[path.size() - 2];
+        }
+        return parents[i] == NoParent ? npos : parents[i];
+    }
+
+    // Edges from the root down to i
+    size_t depth(size_t i) const
+    {
+        if (!hasParents())
+        {
+            return pathTo(i).size() - 1;
+        }
+        size_t d = 0;
+        for (Index p = parents[i]; p != NoParent; p = parents[p])
+        {
+            ++d;
+        }
+        return d;
+    }
+
+    // Indices from the root (0) down to i itself; empty if i is out of range.
+    // Without parents, every step down skips the earlier siblings' subtrees.
+    std::vector<size_t> pathTo(size_t i) const
+    {
+        std::vector<size_t> path;
+        if (i >= count)
+        {
+            return path;
+        }
+        if (hasParents())
+        {
+            for (size_t k = i; k != npos; k = parents[k] == NoParent ? npos : parents[k])
+            {
+                path.push_back(k);
+            }
+            return std::vector<size_t>(path.rbegin(), path.rend());
+        }
+        size_t node = 0;
+        path.push_back(node);
+        while (node != i)
+        {
+            size_t c = node + 1;
+            while (subtreeEnd(c) <= i)
+            {
+                c = subtreeEnd(c);
+            }
+            node = c;
+            path.push_back(node);
+        }
+        return path;
+    }
+
+    size_t memoryBytes() const
+    {
+        size_t parentBytes = parents.capacity() * sizeof(Index);
+        if (backing)
+        {
+            return backingBytes + parentBytes;
+        }
+        return values.capacity() * sizeof(T) + (subtreeSizes.capacity() + childCounts.capacity()) * sizeof(Index) +
+               parentBytes;
+    }
+
+    // Appends nodes in preorder: open() a node, emit its descendants, close() it
+    class Builder
+    {
+    private:
+        FlatTree tree;
+        std::vector<Index> openNodes;
+
+    public:
+        void reserve(size_t n)
+        {
+            tree.values.reserve(n);
+            tree.subtreeSizes.reserve(n);
+            tree.childCounts.reserve(n);
+        }
+
+        size_t open(const T &value)
+        {
+            size_t idx = tree.values.size();
+            if (idx >= std::numeric_limits<Index>::max())
+            {
+                throw std::length_error("FlatTree node count exceeds index range");
+            }
+            if (!openNodes.empty())
+            {
+                tree.childCounts[openNodes.back()]++;
+            }
+            tree.values.push_back(value);
+            tree.subtreeSizes.push_back(1);
+            tree.childCounts.push_back(0);
+            openNodes.push_back(static_cast<Index>(idx));
+            return idx;
+        }
+
+        void close()
+        {
+            Index idx = openNodes.back();
+            openNodes.pop_back();
+            tree.subtreeSizes[idx] = static_cast<Index>(tree.values.size() - idx);
+        }
+
+        // open() + close() for a node without children
+        size_t leaf(const T &value)
+        {
+            size_t idx = open(value);
+            close();
+            return idx;
+        }
+
+        size_t depth() const { return openNodes.size(); }
+
+        FlatTree build()
+        {
+            if (!openNodes.empty())
+            {
+                throw std::logic_error("FlatTree::Builder::build() with unclosed nodes");
+            }
+            tree.bindOwned();
+            return std::move(tree);
+        }
+    };
+};
+
+template <typename T>
+FlatTree<T> FlatTree<T>::fromTree(const std::shared_ptr<TreeNode<T>> &root)
+{
+    Builder builder;
+    if (!root)
+    {
+        return builder.build();
+    }
+
+    // Each frame is a node plus the next child to descend into
+    std::vector<std::pair<const TreeNode<T> *, size_t>> stack;
+    builder.open(root->data);
+    stack.push_back({root.get(), 0});
+
+    while (!stack.empty())
+    {
+        auto &frame = stack.back();
+        const auto &children = frame.first->children;
+
+        // Skip null children, as the pointer-tree searches do
+        while (frame.second < children.size() && !children[frame.second])
+        {
+            frame.second++;
+        }
+
+        if (frame.second == children.size())
+        {
+            builder.close();
+            stack.pop_back();
+            continue;
+        }
+
+        const TreeNode<T> *child = children[frame.second++].get();
+        builder.open(child->data);
+        stack.push_back({child, 0});
+    }
+
+    return builder.build();
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <limits>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "flattree.hpp"
+
+// On-disk FlatTree: a 64-byte header followed by the three preorder arrays
+// (values, subtree sizes, child counts), each starting on a 64-byte boundary.
+// The arrays are exactly FlatTree's in-memory layout, so mapFlatTree can
+// search a file in place: nothing is parsed or copied, and pages are read in
+// as the search first touches them. Files are native-endian; a file written
+// on a machine with a different byte order or element size is rejected.
+struct FlatTreeFileHeader
+{
+    static constexpr char MAGIC[8] = {'F', 'L', 'A', 'T', 'T', 'R', 'E', 'E'};
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr size_t ALIGNMENT = 64;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t valueSize;
+    std::uint32_t indexSize;
+    std::uint64_t nodeCount;
+    std::uint64_t valuesOffset;
+    std::uint64_t subtreeSizesOffset;
+    std::uint64_t childCountsOffset;
+    std::uint64_t fileSize;
+};
+
+static_assert(sizeof(FlatTreeFileHeader) <= FlatTreeFileHeader::ALIGNMENT, "header must fit its block");
+
+namespace flattreefile_detail
+{
+    inline std::uint64_t alignUp(std::uint64_t n)
+    {
+        return (n + FlatTreeFileHeader::ALIGNMENT - 1) & ~std::uint64_t(FlatTreeFileHeader::ALIGNMENT - 1);
+    }
+
+    template <typename T>
+    FlatTreeFileHeader layout(size_t nodeCount)
+    {
+        using Index = typename FlatTree<T>::Index;
+        FlatTreeFileHeader header{};
+        std::memcpy(header.magic, FlatTreeFileHeader::MAGIC, sizeof(header.magic));
+        header.version = FlatTreeFileHeader::VERSION;
+        header.byteOrder = FlatTreeFileHeader::BYTE_ORDER_MARK;
+        header.valueSize = sizeof(T);
+        header.indexSize = sizeof(Index);
+        header.nodeCount = nodeCount;
+        header.valuesOffset = FlatTreeFileHeader::ALIGNMENT;
+        header.subtreeSizesOffset = alignUp(header.valuesOffset + nodeCount * sizeof(T));
+        header.childCountsOffset = alignUp(header.subtreeSizesOffset + nodeCount * sizeof(Index));
+        header.fileSize = header.childCountsOffset + nodeCount * sizeof(Index);
+        return header;
+    }
+
+    inline std::runtime_error error(const std::string &what, const std::string &path)
+    {
+        return std::runtime_error(what + ": " + path);
+    }
+}
+
+// Write tree to path in the format above, replacing any existing file
+template <typename T>
+void writeFlatTree(const FlatTree<T> &tree, const std::string &path)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "FlatTree files hold raw value bytes");
+    using Index = typename FlatTree<T>::Index;
+
+    FlatTreeFileHeader header = flattreefile_detail::layout<T>(tree.size());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        throw flattreefile_detail::error("Cannot open FlatTree file for writing", path);
+    }
+
+    const char zeros[FlatTreeFileHeader::ALIGNMENT] = {};
+    auto padTo = [&](std::uint64_t offset)
+    {
+        std::uint64_t at = static_cast<std::uint64_t>(out.tellp());
+        out.write(zeros, static_cast<std::streamsize>(offset - at));
+    };
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    padTo(header.valuesOffset);
+    out.write(reinterpret_cast<const char *>(tree.data()), static_cast<std::streamsize>(tree.size() * sizeof(T)));
+    padTo(header.subtreeSizesOffset);
+    out.write(reinterpret_cast<const char *>(tree.subtreeSizeData()),
+              static_cast<std::streamsize>(tree.size() * sizeof(Index)));
+    padTo(header.childCountsOffset);
+    out.write(reinterpret_cast<const char *>(tree.childCountData()),
+              static_cast<std::streamsize>(tree.size() * sizeof(Index)));
+
+    out.flush();
+    if (!out)
+    {
+        throw flattreefile_detail::error("Failed writing FlatTree file", path);
+    }
+}
+
+// Map a file written by writeFlatTree and return a view onto it. Only the
+// header is read here; the mapping lives as long as the tree or any copy
+// of it. The arrays are trusted as written.
+template <typename T>
+FlatTree<T> mapFlatTree(const std::string &path)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "FlatTree files hold raw value bytes");
+    using Index = typename FlatTree<T>::Index;
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw flattreefile_detail::error(std::string("Cannot open FlatTree file (") + std::strerror(errno) + ")", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FlatTreeFileHeader))
+    {
+        ::close(fd);
+        throw flattreefile_detail::error("Not a FlatTree file (too short)", path);
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+
+    void *base = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+    {
+        throw flattreefile_detail::error(std::string("Cannot map FlatTree file (") + std::strerror(errno) + ")", path);
+    }
+    std::shared_ptr<const void> mapping(base, [bytes](const void *p)
+                                        { ::munmap(const_cast<void *>(p), bytes); });
+
+    FlatTreeFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, FlatTreeFileHeader::MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw flattreefile_detail::error("Not a FlatTree file (bad magic)", path);
+    }
+    if (header.version != FlatTreeFileHeader::VERSION)
+    {
+        throw flattreefile_detail::error("Unsupported FlatTree file version", path);
+    }
+    if (header.byteOrder != FlatTreeFileHeader::BYTE_ORDER_MARK || header.valueSize != sizeof(T) ||
+        header.indexSize != sizeof(Index))
+    {
+        throw flattreefile_detail::error("FlatTree file was written for a different byte order or value type", path);
+    }
+    if (header.nodeCount >= std::numeric_limits<Index>::max())
+    {
+        throw flattreefile_detail::error("Corrupt FlatTree file (node count out of range)", path);
+    }
+    FlatTreeFileHeader expected = flattreefile_detail::layout<T>(header.nodeCount);
+    if (header.valuesOffset != expected.valuesOffset || header.subtreeSizesOffset != expected.subtreeSizesOffset ||
+        header.childCountsOffset != expected.childCountsOffset || header.fileSize != expected.fileSize ||
+        header.fileSize > bytes)
+    {
+        throw flattreefile_detail::error("Corrupt or truncated FlatTree file", path);
+    }
+
+    const char *bytesAt = static_cast<const char *>(base);
+    return FlatTree<T>::fromView(reinterpret_cast<const T *>(bytesAt + header.valuesOffset),
+                                 reinterpret_cast<const Index *>(bytesAt + header.subtreeSizesOffset),
+                                 reinterpret_cast<const Index *>(bytesAt + header.childCountsOffset),
+                                 static_cast<size_t>(header.nodeCount), std::move(mapping), bytes);
+}
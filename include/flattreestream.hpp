@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "flattree.hpp"
+
+// Records the reader decodes from one read() of the stream
+#ifndef STREAM_READ_BATCH
+#define STREAM_READ_BATCH 4096
+#endif
+
+// Streamed FlatTree: a 32-byte header, then one record per node in DFS
+// preorder, each the raw value bytes followed by the node's child count.
+// Unlike the mapped format (flattreefile.hpp), a producer can emit a node
+// the moment it knows how many children it has, and a reader can use a
+// prefix of the stream before the rest arrives: values and child counts are
+// final as soon as they are read, subtree sizes once the subtree closes.
+// Native-endian, like the mapped format.
+struct FlatTreeStreamHeader
+{
+    static constexpr char MAGIC[8] = {'F', 'T', 'S', 'T', 'R', 'E', 'A', 'M'};
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    // nodeCount when the producer doesn't know it up front
+    static constexpr std::uint64_t UNKNOWN_COUNT = std::numeric_limits<std::uint64_t>::max();
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t valueSize;
+    std::uint32_t indexSize;
+    std::uint64_t nodeCount;
+};
+
+// Emits a tree one node at a time, in preorder
+template <typename T>
+class FlatTreeStreamWriter
+{
+    static_assert(std::is_trivially_copyable<T>::value, "FlatTree streams hold raw value bytes");
+
+public:
+    using Index = typename FlatTree<T>::Index;
+
+    explicit FlatTreeStreamWriter(std::ostream &stream, std::uint64_t nodeCount = FlatTreeStreamHeader::UNKNOWN_COUNT)
+        : out(stream)
+    {
+        FlatTreeStreamHeader header{};
+        std::memcpy(header.magic, FlatTreeStreamHeader::MAGIC, sizeof(header.magic));
+        header.version = FlatTreeStreamHeader::VERSION;
+        header.byteOrder = FlatTreeStreamHeader::BYTE_ORDER_MARK;
+        header.valueSize = sizeof(T);
+        header.indexSize = sizeof(Index);
+        header.nodeCount = nodeCount;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        check();
+    }
+
+    void node(const T &value, Index childCount)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        out.write(reinterpret_cast<const char *>(&childCount), sizeof(Index));
+        check();
+    }
+
+    void flush()
+    {
+        out.flush();
+        check();
+    }
+
+private:
+    std::ostream &out;
+
+    void check()
+    {
+        if (!out)
+        {
+            throw std::runtime_error("Failed writing FlatTree stream");
+        }
+    }
+};
+
+template <typename T>
+void writeFlatTreeStream(const FlatTree<T> &tree, std::ostream &out)
+{
+    FlatTreeStreamWriter<T> writer(out, tree.size());
+    for (size_t i = 0; i < tree.size(); ++i)
+    {
+        writer.node(tree.value(i), tree.childCount(i));
+    }
+    writer.flush();
+}
+
+// Incrementally loads a streamed tree into preorder arrays. readChunk()
+// appends nodes without ever moving the ones already loaded, so a search
+// may scan [0, size()) while the next chunk is read; only grow() moves
+// them. ParallelTreeSearch::searchStream drives it that way.
+template <typename T>
+class FlatTreeStreamReader
+{
+    static_assert(std::is_trivially_copyable<T>::value, "FlatTree streams hold raw value bytes");
+
+public:
+    using Index = typename FlatTree<T>::Index;
+
+    // Reads the header; reserves the whole tree if the producer gave its size
+    explicit FlatTreeStreamReader(std::istream &stream, size_t initialCapacity = size_t(1) << 16) : in(stream)
+    {
+        FlatTreeStreamHeader header;
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            throw std::runtime_error("Not a FlatTree stream (too short)");
+        }
+        if (std::memcmp(header.magic, FlatTreeStreamHeader::MAGIC, sizeof(header.magic)) != 0)
+        {
+            throw std::runtime_error("Not a FlatTree stream (bad magic)");
+        }
+        if (header.version != FlatTreeStreamHeader::VERSION)
+        {
+            throw std::runtime_error("Unsupported FlatTree stream version");
+        }
+        if (header.byteOrder != FlatTreeStreamHeader::BYTE_ORDER_MARK || header.valueSize != sizeof(T) ||
+            header.indexSize != sizeof(Index))
+        {
+            throw std::runtime_error("FlatTree stream was written for a different byte order or value type");
+        }
+        if (header.nodeCount != FlatTreeStreamHeader::UNKNOWN_COUNT)
+        {
+            if (header.nodeCount >= std::numeric_limits<Index>::max())
+            {
+                throw std::length_error("FlatTree node count exceeds index range");
+            }
+            expected = static_cast<size_t>(header.nodeCount);
+            initialCapacity = expected;
+            finished = expected == 0;
+        }
+        reserve(initialCapacity);
+    }
+
+    // Nodes loaded so far, and whether the root's subtree is complete
+    size_t size() const { return values.size(); }
+    bool done() const { return finished; }
+
+    // Room for more nodes before grow() is needed
+    size_t spare() const { return values.capacity() - values.size(); }
+
+    // Loaded values; stable until the next grow()
+    const T *data() const { return values.data(); }
+
+    // Read up to min(maxNodes, spare()) more nodes, blocking on the stream
+    // as needed; returns how many were read. Throws if the stream ends
+    // before the root's subtree is complete.
+    size_t readChunk(size_t maxNodes)
+    {
+        size_t want = std::min(maxNodes, spare());
+        if (expected != FlatTreeStreamHeader::UNKNOWN_COUNT && !finished)
+        {
+            if (values.size() == expected)
+            {
+                throw std::runtime_error("FlatTree stream holds more nodes than its header says");
+            }
+            want = std::min(want, expected - values.size());
+        }
+
+        size_t read = 0;
+        while (read < want && !finished)
+        {
+            // Never past the record that closes the root: a producer may keep
+            // the stream open, or follow the tree with other data
+            size_t batch = std::min<size_t>({want - read, STREAM_READ_BATCH, owed});
+            staging.resize(batch * RECORD_BYTES);
+            in.read(staging.data(), static_cast<std::streamsize>(staging.size()));
+            size_t got = static_cast<size_t>(in.gcount()) / RECORD_BYTES;
+            for (size_t r = 0; r < got && !finished; ++r)
+            {
+                const char *record = staging.data() + r * RECORD_BYTES;
+                T value;
+                Index childCount;
+                std::memcpy(&value, record, sizeof(T));
+                std::memcpy(&childCount, record + sizeof(T), sizeof(Index));
+                append(value, childCount);
+                ++read;
+            }
+            if (got < batch && !finished)
+            {
+                throw std::runtime_error("FlatTree stream ended inside a subtree");
+            }
+        }
+        return read;
+    }
+
+    // Make room for at least n more nodes. Moves the loaded arrays, so
+    // nothing may be scanning data() meanwhile.
+    void grow(size_t n)
+    {
+        reserve(std::max(values.size() + n, values.capacity() * 2));
+    }
+
+    // Everything loaded so far as a FlatTree. Subtrees still open are cut
+    // off at the last node read, so a search that stopped ingestion early
+    // still leaves a valid (partial) tree. The reader is empty afterwards.
+    FlatTree<T> take()
+    {
+        for (const OpenNode &open : openNodes)
+        {
+            subtreeSizes[open.index] = static_cast<Index>(values.size() - open.index);
+            childCounts[open.index] = open.seen;
+        }
+        openNodes.clear();
+        owed = 0;
+        finished = true;
+        return FlatTree<T>::fromArrays(std::move(values), std::move(subtreeSizes), std::move(childCounts));
+    }
+
+private:
+    static constexpr size_t RECORD_BYTES = sizeof(T) + sizeof(Index);
+
+    struct OpenNode
+    {
+        Index index;
+        Index remaining;
+        Index seen;
+    };
+
+    std::istream &in;
+    std::vector<T> values;
+    std::vector<Index> subtreeSizes;
+    std::vector<Index> childCounts;
+    std::vector<OpenNode> openNodes;
+    std::vector<char> staging;
+    size_t expected = FlatTreeStreamHeader::UNKNOWN_COUNT;
+    // Records still needed at least to close the root: the children the
+    // open nodes are missing, or the root itself before it is read
+    size_t owed = 1;
+    bool finished = false;
+
+    void reserve(size_t n)
+    {
+        if (n >= std::numeric_limits<Index>::max())
+        {
+            n = std::numeric_limits<Index>::max() - 1;
+        }
+        values.reserve(n);
+        subtreeSizes.reserve(n);
+        childCounts.reserve(n);
+    }
+
+    void append(const T &value, Index childCount)
+    {
+        Index idx = static_cast<Index>(values.size());
+        if (!openNodes.empty())
+        {
+            openNodes.back().remaining--;
+            openNodes.back().seen++;
+        }
+        values.push_back(value);
+        subtreeSizes.push_back(1);
+        childCounts.push_back(childCount);
+        openNodes.push_back({idx, childCount, 0});
+        owed = owed - 1 + childCount;
+
+        // Close every subtree this node completes
+        while (!openNodes.empty() && openNodes.back().remaining == 0)
+        {
+            subtreeSizes[openNodes.back().index] = static_cast<Index>(values.size() - openNodes.back().index);
+            openNodes.pop_back();
+        }
+        finished = openNodes.empty();
+    }
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bytes of inline storage in an InlineTask
+#ifndef INLINE_TASK_SIZE
+#define INLINE_TASK_SIZE 48
+#endif
+
+// Move-only void() callable with small-buffer storage. Anything up to
+// INLINE_TASK_SIZE bytes that can be moved without throwing lives inside
+// the task itself, so wrapping, queueing and running it never allocates;
+// larger callables fall back to one heap allocation, like std::function.
+class InlineTask
+{
+public:
+    static constexpr size_t Capacity = INLINE_TASK_SIZE;
+
+    template <typename F>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+    InlineTask() noexcept = default;
+
+    template <typename F, typename Fn = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<Fn, InlineTask>::value>::type>
+    InlineTask(F &&f)
+    {
+        if constexpr (fitsInline<Fn>())
+        {
+            ::new (static_cast<void *>(storage)) Fn(std::forward<F>(f));
+            ops = &inlineOps<Fn>;
+        }
+        else
+        {
+            ::new (static_cast<void *>(storage)) Fn *(new Fn(std::forward<F>(f)));
+            ops = &boxedOps<Fn>;
+        }
+    }
+
+    InlineTask(InlineTask &&other) noexcept
+    {
+        take(other);
+    }
+
+    InlineTask &operator=(InlineTask &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    InlineTask(const InlineTask &) = delete;
+    InlineTask &operator=(const InlineTask &) = delete;
+
+    ~InlineTask() { reset(); }
+
+    void operator()() { ops->invoke(storage); }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    void reset() noexcept
+    {
+        if (ops)
+        {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops
+    {
+        void (*invoke)(void *);
+        // Move-construct into dst and destroy src
+        void (*relocate)(void *dst, void *src) noexcept;
+        void (*destroy)(void *) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr Ops inlineOps{
+        [](void *p)
+        { (*static_cast<Fn *>(p))(); },
+        [](void *dst, void *src) noexcept
+        {
+            ::new (dst) Fn(std::move(*static_cast<Fn *>(src)));
+            static_cast<Fn *>(src)->~Fn();
+        },
+        [](void *p) noexcept
+        { static_cast<Fn *>(p)->~Fn(); }};
+
+    template <typename Fn>
+    static constexpr Ops boxedOps{
+        [](void *p)
+        { (**static_cast<Fn **>(p))(); },
+        [](void *dst, void *src) noexcept
+        { ::new (dst) Fn *(*static_cast<Fn **>(src)); },
+        [](void *p) noexcept
+        { delete *static_cast<Fn **>(p); }};
+
+    void take(InlineTask &other) noexcept
+    {
+        if (other.ops)
+        {
+            other.ops->relocate(storage, other.storage);
+            ops = other.ops;
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+    const Ops *ops = nullptr;
+};
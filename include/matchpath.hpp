@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// A match and the nodes leading to it: path runs from the root (path[0])
+// down to the match itself (path.back()), so depth is path.size() - 1.
+// Without a match, match is null (or npos), path is empty and depth is -1.
+template <typename R>
+struct MatchPath
+{
+    R match{};
+    int depth = -1;
+    std::vector<R> path;
+
+    bool found() const { return depth >= 0; }
+};
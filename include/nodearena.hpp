@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for tree nodes. Allocation is a pointer increment inside a
+// large block; nothing is freed individually. release() (or destruction)
+// runs any registered destructors and returns every block at once.
+class NodeArena
+{
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    struct Cleanup
+    {
+        void (*destroy)(void *);
+        void *object;
+    };
+
+    const size_t blockBytes;
+    std::vector<Block> blocks;
+    std::vector<Cleanup> cleanups;
+    std::byte *cursor = nullptr;
+    size_t remaining = 0;
+    size_t used = 0;
+
+    void addBlock(size_t minBytes)
+    {
+        size_t size = minBytes > blockBytes ? minBytes : blockBytes;
+        blocks.push_back(Block{std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+        cursor = blocks.back().memory.get();
+        remaining = size;
+    }
+
+public:
+    explicit NodeArena(size_t blockSize = 1 << 20) : blockBytes(blockSize) {}
+
+    NodeArena(const NodeArena &) = delete;
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    NodeArena(NodeArena &&other) noexcept
+        : blockBytes(other.blockBytes), blocks(std::move(other.blocks)), cleanups(std::move(other.cleanups)),
+          cursor(other.cursor), remaining(other.remaining), used(other.used)
+    {
+        other.cursor = nullptr;
+        other.remaining = 0;
+        other.used = 0;
+    }
+
+    ~NodeArena() { release(); }
+
+    void *allocate(size_t bytes, size_t align)
+    {
+        std::uintptr_t p = reinterpret_cast<std::uintptr_t>(cursor);
+        size_t pad = (align - (p & (align - 1))) & (align - 1);
+        if (!cursor || pad + bytes > remaining)
+        {
+            addBlock(bytes + align);
+            p = reinterpret_cast<std::uintptr_t>(cursor);
+            pad = (align - (p & (align - 1))) & (align - 1);
+        }
+        std::byte *out = cursor + pad;
+        cursor = out + bytes;
+        remaining -= pad + bytes;
+        used += bytes;
+        return out;
+    }
+
+    template <typename U, typename... Args>
+    U *create(Args &&...args)
+    {
+        U *obj = new (allocate(sizeof(U), alignof(U))) U(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible<U>::value)
+        {
+            cleanups.push_back(Cleanup{[](void *p) { static_cast<U *>(p)->~U(); }, obj});
+        }
+        return obj;
+    }
+
+    // Uninitialized storage for n trivially constructible elements
+    template <typename U>
+    U *allocateArray(size_t n)
+    {
+        static_assert(std::is_trivially_destructible<U>::value, "arena arrays are never destroyed");
+        return static_cast<U *>(allocate(sizeof(U) * n, alignof(U)));
+    }
+
+    // Destroy everything at once
+    void release()
+    {
+        for (size_t i = cleanups.size(); i-- > 0;)
+        {
+            cleanups[i].destroy(cleanups[i].object);
+        }
+        cleanups.clear();
+        blocks.clear();
+        cursor = nullptr;
+        remaining = 0;
+        used = 0;
+    }
+
+    size_t bytesUsed() const { return used; }
+
+    size_t bytesReserved() const
+    {
+        size_t total = 0;
+        for (const auto &b : blocks)
+            total += b.size;
+        return total;
+    }
+};
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "flattree.hpp"
+#include "arenatree.hpp"
+#include "numatopology.hpp"
+
+// One NUMA node's share of a placed FlatTree: preorder indices [begin, end)
+struct NumaSlice
+{
+    size_t begin;
+    size_t end;
+    int node;
+};
+
+// A FlatTree whose arrays are split between NUMA nodes at top-level subtree
+// boundaries, each slice first touched (so backed by pages) on the node
+// that owns it. ParallelTreeSearch seeds each slice on its own node.
+template <typename T>
+class NumaFlatTree
+{
+public:
+    NumaFlatTree() = default;
+    NumaFlatTree(FlatTree<T> tree, std::vector<NumaSlice> slices) : flat(std::move(tree)), parts(std::move(slices)) {}
+
+    const FlatTree<T> &tree() const { return flat; }
+    const std::vector<NumaSlice> &slices() const { return parts; }
+    size_t size() const { return flat.size(); }
+    bool empty() const { return flat.empty(); }
+
+private:
+    FlatTree<T> flat;
+    std::vector<NumaSlice> parts;
+};
+
+namespace numaplacement_detail
+{
+    // Cut a sequence of subtrees (sizes, in order) into at most parts
+    // contiguous groups of similar total size; returns the index of each
+    // group's first subtree
+    inline std::vector<size_t> groupStarts(const std::vector<size_t> &sizes, size_t parts)
+    {
+        size_t total = 0;
+        for (size_t s : sizes)
+        {
+            total += s;
+        }
+        std::vector<size_t> starts;
+        size_t done = 0;
+        for (size_t k = 0; k < sizes.size(); ++k)
+        {
+            // Open group g once the subtrees before k reach g / parts of the total
+            if (starts.empty() || (starts.size() < parts && done * parts >= starts.size() * total))
+            {
+                starts.push_back(k);
+            }
+            done += sizes[k];
+        }
+        return starts;
+    }
+
+    // Run job(g) for every group on a thread pinned to nodes[g], all at once.
+    // With a single node there is nothing to place, so the caller runs them.
+    template <typename Job>
+    void runOnNodes(const std::vector<int> &nodes, const NumaTopology &topology, Job &job)
+    {
+        if (topology.nodeCount() < 2)
+        {
+            for (size_t g = 0; g < nodes.size(); ++g)
+            {
+                job(g);
+            }
+            return;
+        }
+        std::vector<std::thread> threads;
+        for (size_t g = 0; g < nodes.size(); ++g)
+        {
+            threads.emplace_back([&, g]
+                                 {
+                pinCurrentThreadToNode(nodes[g], topology);
+                job(g); });
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
+
+    struct AlignedFree
+    {
+        void operator()(void *p) const { ::operator delete(p, std::align_val_t{64}); }
+    };
+}
+
+// Copy tree into memory split across topology's nodes. The root's children
+// are grouped into one run of whole subtrees per node (the root goes with
+// the first), and each run is copied by a thread pinned to its node, so
+// the kernel backs it with that node's pages. Trees whose root has fewer
+// children than there are nodes get fewer slices.
+template <typename T>
+NumaFlatTree<T> placeFlatTree(const FlatTree<T> &tree, const NumaTopology &topology = NumaTopology::system())
+{
+    static_assert(std::is_trivially_copyable<T>::value, "placed FlatTrees copy raw value bytes");
+
+    using Index = typename FlatTree<T>::Index;
+    namespace detail = numaplacement_detail;
+
+    size_t n = tree.size();
+    if (n == 0)
+    {
+        return {};
+    }
+
+    std::vector<size_t> childStarts;
+    std::vector<size_t> childSizes;
+    for (size_t c = tree.firstChild(0); c != FlatTree<T>::npos; c = tree.nextSibling(c, n))
+    {
+        childStarts.push_back(c);
+        childSizes.push_back(tree.subtreeSize(c));
+    }
+    std::vector<NumaSlice> slices;
+    std::vector<size_t> groups = detail::groupStarts(childSizes, topology.nodeCount());
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        size_t begin = g == 0 ? 0 : childStarts[groups[g]];
+        size_t end = g + 1 < groups.size() ? childStarts[groups[g + 1]] : n;
+        slices.push_back({begin, end, static_cast<int>(g)});
+    }
+    if (slices.empty())
+    {
+        slices.push_back({0, n, 0});
+    }
+
+    // One block, each array on its own cache line; operator new leaves the
+    // pages untouched, so the copies below decide where they live
+    auto align = [](size_t bytes) { return (bytes + 63) & ~size_t(63); };
+    size_t valuesBytes = align(n * sizeof(T));
+    size_t indexBytes = align(n * sizeof(Index));
+    size_t bytes = valuesBytes + 2 * indexBytes;
+    std::shared_ptr<void> block(::operator new(bytes, std::align_val_t{64}), detail::AlignedFree{});
+    auto *base = static_cast<std::byte *>(block.get());
+    T *values = reinterpret_cast<T *>(base);
+    Index *sizes = reinterpret_cast<Index *>(base + valuesBytes);
+    Index *counts = reinterpret_cast<Index *>(base + valuesBytes + indexBytes);
+
+    std::vector<int> nodes;
+    for (const auto &slice : slices)
+    {
+        nodes.push_back(slice.node);
+    }
+    auto copy = [&](size_t g)
+    {
+        size_t b = slices[g].begin;
+        size_t len = slices[g].end - b;
+        std::memcpy(values + b, tree.data() + b, len * sizeof(T));
+        std::memcpy(sizes + b, tree.subtreeSizeData() + b, len * sizeof(Index));
+        std::memcpy(counts + b, tree.childCountData() + b, len * sizeof(Index));
+    };
+    detail::runOnNodes(nodes, topology, copy);
+
+    return NumaFlatTree<T>(FlatTree<T>::fromView(values, sizes, counts, n, std::move(block), bytes), std::move(slices));
+}
+
+// Copy tree so each node's run of top-level subtrees (grouped as in
+// placeFlatTree) lives in an arena shard built on that node. Only the root
+// and its child array stay with the calling thread. Ids are renumbered
+// densely in the copy's own creation order.
+template <typename T>
+ArenaTree<T> placeArenaTree(const ArenaTree<T> &tree, const NumaTopology &topology = NumaTopology::system())
+{
+    namespace detail = numaplacement_detail;
+
+    ArenaTree<T> placed;
+    const ArenaTreeNode<T> *root = tree.root();
+    if (!root)
+    {
+        return placed;
+    }
+    placed.setRoot(placed.createNode(root->data));
+    placed.reserveChildren(placed.root(), root->childCount());
+
+    std::vector<size_t> childSizes;
+    std::vector<const ArenaTreeNode<T> *> stack;
+    for (const ArenaTreeNode<T> *child : *root)
+    {
+        size_t size = 0;
+        stack.push_back(child);
+        while (!stack.empty())
+        {
+            const ArenaTreeNode<T> *node = stack.back();
+            stack.pop_back();
+            ++size;
+            for (const ArenaTreeNode<T> *c : *node)
+            {
+                stack.push_back(c);
+            }
+        }
+        childSizes.push_back(size);
+    }
+    std::vector<size_t> groups = detail::groupStarts(childSizes, topology.nodeCount());
+    groups.push_back(childSizes.size());
+
+    std::vector<std::unique_ptr<typename ArenaTree<T>::Shard>> shards;
+    std::vector<int> nodes;
+    size_t firstId = 1;
+    for (size_t g = 0; g + 1 < groups.size(); ++g)
+    {
+        shards.push_back(std::make_unique<typename ArenaTree<T>::Shard>(firstId));
+        nodes.push_back(static_cast<int>(g));
+        for (size_t k = groups[g]; k < groups[g + 1]; ++k)
+        {
+            firstId += childSizes[k];
+        }
+    }
+
+    std::vector<ArenaTreeNode<T> *> copies(root->childCount());
+    auto build = [&](size_t g)
+    {
+        auto &shard = *shards[g];
+        std::vector<std::pair<const ArenaTreeNode<T> *, ArenaTreeNode<T> *>> pending;
+        for (size_t k = groups[g]; k < groups[g + 1]; ++k)
+        {
+            copies[k] = shard.createNode(root->child(k)->data);
+            pending.push_back({root->child(k), copies[k]});
+            while (!pending.empty())
+            {
+                auto [src, dst] = pending.back();
+                pending.pop_back();
+                shard.reserveChildren(dst, src->childCount());
+                for (const ArenaTreeNode<T> *c : *src)
+                {
+                    ArenaTreeNode<T> *copy = shard.createNode(c->data);
+                    shard.addChild(dst, copy);
+                    pending.push_back({c, copy});
+                }
+            }
+        }
+    };
+    detail::runOnNodes(nodes, topology, build);
+
+    for (auto &shard : shards)
+    {
+        placed.adopt(std::move(*shard));
+    }
+    for (ArenaTreeNode<T> *copy : copies)
+    {
+        placed.addChild(placed.root(), copy);
+    }
+    return placed;
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// How ThreadPool places its workers on CPUs
+enum class WorkerPinning
+{
+    // Threads float wherever the OS schedules them
+    None,
+    // Worker i on the i-th allowed CPU: fill one NUMA node before the next
+    Compact,
+    // Workers dealt round-robin across NUMA nodes, so every node gets some
+    Spread
+};
+
+// The CPUs this process may run on, grouped by NUMA node as the kernel
+// reports them (/sys/devices/system/node on Linux). Nodes are renumbered
+// densely and nodes without allowed CPUs are dropped. Anywhere the
+// topology can't be read, all hardware threads form one node.
+struct NumaTopology
+{
+    std::vector<std::vector<int>> nodeCpus;
+
+    size_t nodeCount() const { return nodeCpus.size(); }
+
+    size_t cpuCount() const
+    {
+        size_t n = 0;
+        for (const auto &cpus : nodeCpus)
+        {
+            n += cpus.size();
+        }
+        return n;
+    }
+
+    // Node holding cpu, or -1
+    int nodeOf(int cpu) const
+    {
+        for (size_t node = 0; node < nodeCpus.size(); ++node)
+        {
+            if (std::find(nodeCpus[node].begin(), nodeCpus[node].end(), cpu) != nodeCpus[node].end())
+            {
+                return static_cast<int>(node);
+            }
+        }
+        return -1;
+    }
+
+    // CPU for pool worker i under pinning, or -1 for None
+    int cpuFor(WorkerPinning pinning, size_t worker) const
+    {
+        if (pinning == WorkerPinning::None || nodeCpus.empty())
+        {
+            return -1;
+        }
+        if (pinning == WorkerPinning::Spread)
+        {
+            const auto &cpus = nodeCpus[worker % nodeCpus.size()];
+            return cpus[(worker / nodeCpus.size()) % cpus.size()];
+        }
+        size_t k = worker % cpuCount();
+        for (const auto &cpus : nodeCpus)
+        {
+            if (k < cpus.size())
+            {
+                return cpus[k];
+            }
+            k -= cpus.size();
+        }
+        return -1;
+    }
+
+    static NumaTopology detect()
+    {
+        NumaTopology topology;
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool masked = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+        std::vector<std::pair<int, std::vector<int>>> found;
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec))
+        {
+            std::string name = entry.path().filename().string();
+            if (name.size() < 5 || name.compare(0, 4, "node") != 0 ||
+                name.find_first_not_of("0123456789", 4) != std::string::npos)
+            {
+                continue;
+            }
+            std::ifstream in(entry.path() / "cpulist");
+            std::string list;
+            std::getline(in, list);
+            std::vector<int> cpus;
+            for (int cpu : parseCpuList(list))
+            {
+                if (!masked || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty())
+            {
+                found.push_back({std::stoi(name.substr(4)), std::move(cpus)});
+            }
+        }
+        std::sort(found.begin(), found.end());
+        for (auto &node : found)
+        {
+            topology.nodeCpus.push_back(std::move(node.second));
+        }
+#endif
+        if (topology.nodeCpus.empty())
+        {
+            std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+            for (size_t i = 0; i < cpus.size(); ++i)
+            {
+                cpus[i] = static_cast<int>(i);
+            }
+            topology.nodeCpus.push_back(std::move(cpus));
+        }
+        return topology;
+    }
+
+    // Detected once, on first use
+    static const NumaTopology &system()
+    {
+        static const NumaTopology topology = detect();
+        return topology;
+    }
+
+    // "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}; malformed items are skipped
+    static std::vector<int> parseCpuList(const std::string &list)
+    {
+        std::vector<int> cpus;
+        size_t pos = 0;
+        while (pos < list.size())
+        {
+            size_t comma = list.find(',', pos);
+            std::string item = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            pos = comma == std::string::npos ? list.size() : comma + 1;
+            try
+            {
+                size_t dash = item.find('-');
+                int first = std::stoi(item.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            catch (const std::logic_error &)
+            {
+            }
+        }
+        return cpus;
+    }
+};
+
+// NUMA node the calling thread was pinned to, or -1 if it never was (or
+// pinning failed). Searches use it to steal from nearby workers first.
+inline int &currentNumaNodeSlot()
+{
+    thread_local int node = -1;
+    return node;
+}
+
+inline int currentNumaNode()
+{
+    return currentNumaNodeSlot();
+}
+
+// Restrict the calling thread to cpus; false where that isn't supported
+inline bool pinCurrentThread(const std::vector<int> &cpus, int node)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0)
+    {
+        currentNumaNodeSlot() = node;
+        return true;
+    }
+#else
+    (void)cpus;
+    (void)node;
+#endif
+    return false;
+}
+
+inline bool pinCurrentThreadToCpu(int cpu, const NumaTopology &topology = NumaTopology::system())
+{
+    return pinCurrentThread({cpu}, topology.nodeOf(cpu));
+}
+
+// Any CPU of node will do; for threads that only need their memory local
+inline bool pinCurrentThreadToNode(int node, const NumaTopology &topology = NumaTopology::system())
+{
+    if (node < 0 || static_cast<size_t>(node) >= topology.nodeCount())
+    {
+        return false;
+    }
+    return pinCurrentThread(topology.nodeCpus[node], node);
+}
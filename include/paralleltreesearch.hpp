@@ -4,16 +4,41 @@
 #include <mutex>
 #include <condition_variable>
 #include <vector>
-#include <queue>
+#include <deque>
 #include <functional>
 #include <atomic>
 #include <memory>
 #include <optional>
 #include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <span>
+#include <limits>
+#include <chrono>
+#include <future>
+#include <concepts>
+#include <type_traits>
+#include <stdexcept>
+#include <latch>
 
 #include "treenode.hpp"
+#include "threadpool.hpp"
+#include "flattree.hpp"
+#include "flattreestream.hpp"
+#include "arenatree.hpp"
+#include "visitepochs.hpp"
+#include "targetset.hpp"
+#include "searchlimits.hpp"
+#include "valueindex.hpp"
+#include "subtreesummary.hpp"
+#include "matchpath.hpp"
+#include "numaplacement.hpp"
+#include "simdscan.hpp"
+#include "workstealingdeque.hpp"
 
-// Tunables (can be tweaked from benchmark by recompiling)
+// Defaults for SplitPolicy::fixed() (can be tweaked from benchmark by recompiling).
+// Spawning is a push onto the owner's own deque, so raising these no longer
+// contends on a shared queue; they only bound the number of live tasks.
 #ifndef PAR_CUTOFF_DEPTH
 #define PAR_CUTOFF_DEPTH 4
 #endif
@@ -22,179 +47,2306 @@
 #define MAX_PAR_CHILDREN 2
 #endif
 
-template <typename T>
+// Initial capacity of each worker's explicit traversal stack
+#ifndef TRAVERSAL_STACK_RESERVE
+#define TRAVERSAL_STACK_RESERVE 1024
+#endif
+
+// FlatTree scans check for a split or a published match once per block
+#ifndef FLAT_SCAN_BLOCK
+#define FLAT_SCAN_BLOCK 4096
+#endif
+
+// Nodes a worker visits between polls of the query's SearchLimits
+#ifndef LIMIT_CHECK_INTERVAL
+#define LIMIT_CHECK_INTERVAL 1024
+#endif
+
+// Failed steal sweeps an idle worker makes before parking
+#ifndef STEAL_SPIN_ROUNDS
+#define STEAL_SPIN_ROUNDS 64
+#endif
+
+// Longest a parked worker sleeps before rechecking whether other queries
+// are waiting for its thread
+#ifndef PARK_TIMEOUT_US
+#define PARK_TIMEOUT_US 1000
+#endif
+
+// Nodes a worker visits before it hands its thread to other queued jobs
+// (checked at each limit poll, and only if something is actually waiting)
+#ifndef QUERY_TIME_SLICE
+#define QUERY_TIME_SLICE 16384
+#endif
+
+// Nodes searchStream reads before handing them to the workers
+#ifndef STREAM_CHUNK_NODES
+#define STREAM_CHUNK_NODES 65536
+#endif
+
+// Breadth-first levels are split into blocks of this many frontier nodes
+#ifndef LEVEL_SCAN_BLOCK
+#define LEVEL_SCAN_BLOCK 256
+#endif
+
+// Hybrid order: frontier nodes per worker to collect before going depth-first
+#ifndef HYBRID_FRONTIER_PER_WORKER
+#define HYBRID_FRONTIER_PER_WORKER 8
+#endif
+
+// Hybrid order: never expand a level into a frontier larger than this
+#ifndef HYBRID_MAX_FRONTIER
+#define HYBRID_MAX_FRONTIER 65536
+#endif
+
+// How search() decides to hand subtrees to other workers
+enum class SplitMode {
+    // Spawn up to maxParChildren children per node above cutoffDepth, then go sequential
+    Static,
+    // Stay sequential and give away untraversed siblings whenever a worker is idle
+    Adaptive
+};
+
+struct SplitPolicy {
+    SplitMode mode = SplitMode::Adaptive;
+    int cutoffDepth = PAR_CUTOFF_DEPTH;
+    size_t maxParChildren = MAX_PAR_CHILDREN;
+
+    static SplitPolicy fixed(int cutoffDepth = PAR_CUTOFF_DEPTH, size_t maxParChildren = MAX_PAR_CHILDREN) {
+        return SplitPolicy{SplitMode::Static, cutoffDepth, maxParChildren};
+    }
+
+    static SplitPolicy adaptive() { return SplitPolicy{}; }
+};
+
+// Compile-time switches for ParallelTreeSearch's traversal loops. They are
+// tested with if constexpr, so a feature switched off costs nothing, not
+// even a branch. Derive from SearchTraits and override what you need.
+struct SearchTraits {
+    // Per-seat task, steal and timing counters (getStats(), SearchResult::stats).
+    // Visited nodes are counted either way.
+    static constexpr bool stats = true;
+    // SearchLimits, and handing threads back every QUERY_TIME_SLICE nodes,
+    // both polled every LIMIT_CHECK_INTERVAL nodes. Without limits a query
+    // keeps its threads until it ends, bounds that limit anything are
+    // rejected, and visited nodes are only added up as tasks finish.
+    static constexpr bool limits = true;
+    // Use split instead of the runtime SplitPolicy's mode
+    static constexpr bool fixedSplit = false;
+    static constexpr SplitMode split = SplitMode::Adaptive;
+};
+
+// Throughput build: no statistics or limits, always adaptive splitting
+struct LeanSearchTraits : SearchTraits {
+    static constexpr bool stats = false;
+    static constexpr bool limits = false;
+    static constexpr bool fixedSplit = true;
+};
+
+// How search() and findFirst() walk a pointer tree
+enum class TraversalOrder {
+    // Depth-first from the root, split between workers as SplitPolicy says
+    DepthFirst,
+    // Level by level: each level's frontier is split between the workers,
+    // which collect the next level in buffers of their own. Finds a
+    // shallowest match, but holds a whole level in memory.
+    BreadthFirst,
+    // Breadth-first until the frontier has HYBRID_FRONTIER_PER_WORKER nodes
+    // per worker (or the next level would exceed HYBRID_MAX_FRONTIER), then
+    // depth-first below every frontier node
+    Hybrid
+};
+
+// Which match search() and findFirst() return when there are several
+enum class MatchMode {
+    // Whichever a worker reaches first; the query ends on the first match
+    Any,
+    // The one a sequential DFS would find, still searched in parallel
+    Leftmost
+};
+
+template <typename T, typename Traits = SearchTraits>
 class ParallelTreeSearch
 {
 private:
+    // Trivially copyable so it can live in a lock-free deque. TreeNode tasks
+    // point at the shared_ptr owned by the parent's children vector (or the
+    // caller's root), which stays valid for the duration of the query;
+    // ArenaTree tasks point at the node itself.
+    //
+    // [lo, hi) orders tasks in DFS order: for FlatTree tasks it is the
+    // preorder index range itself; for pointer-tree tasks it is an interval
+    // of an abstract key space, split along with the work (see split_stack),
+    // such that disjoint tasks compare like their subtrees in preorder.
+    struct Trail;
     struct Task {
-        std::shared_ptr<TreeNode<T>> node;
+        union {
+            const std::shared_ptr<TreeNode<T>>* shared;
+            const ArenaTreeNode<T>* arena;
+        };
+        std::uint64_t lo;
+        std::uint64_t hi;
+        // Path-tracking queries only: the task's parent (null at the root)
+        const Trail* trail;
         int depth;
+        // stamp() when the task was queued; 32 bits keep Task at five words,
+        // so waits of 4 s or more wrap in the statistics
+        std::uint32_t queuedAt;
+
+        static Task range(size_t b, size_t e) {
+            Task t{};
+            t.lo = b;
+            t.hi = e;
+            return t;
+        }
+    };
+
+    // One node of a path-tracking query's parent chains, made only when a
+    // task needs its ancestors: when work is handed to another task, and
+    // when a match is recorded. Chains are shared by every task below them
+    // and live until the query is recycled.
+    struct Trail {
+        Task frame;
+        const Trail* parent;
+    };
+
+    static constexpr std::uint64_t NoKey = std::numeric_limits<std::uint64_t>::max();
+    static constexpr int NoDepth = std::numeric_limits<int>::max();
+
+    // Adapters that let one traversal run over each pointer-tree representation
+    struct SharedLinks {
+        using Handle = const std::shared_ptr<TreeNode<T>>*;
+        using Result = std::shared_ptr<TreeNode<T>>;
+        static Result result(Handle h) { return *h; }
+        static Handle get(const Task& t) { return t.shared; }
+        static Task make(Handle h, int depth) { Task t{}; t.shared = h; t.depth = depth; return t; }
+        static Task root(Handle h) { Task t = make(h, 0); t.hi = NoKey; return t; }
+        static bool valid(Handle h) { return static_cast<bool>(*h); }
+        static const T& value(Handle h) { return (*h)->data; }
+        static size_t childCount(Handle h) { return (*h)->children.size(); }
+        static Handle child(Handle h, size_t i) { return &(*h)->children[i]; }
+        static constexpr bool hasId = false;
+        static size_t id(Handle) { return 0; }
+    };
+
+    struct ArenaLinks {
+        using Handle = const ArenaTreeNode<T>*;
+        using Result = const ArenaTreeNode<T>*;
+        static Result result(Handle h) { return h; }
+        static Handle get(const Task& t) { return t.arena; }
+        static Task make(Handle h, int depth) { Task t{}; t.arena = h; t.depth = depth; return t; }
+        static Task root(Handle h) { Task t = make(h, 0); t.hi = NoKey; return t; }
+        // ArenaTree never links a null child, and roots are checked before
+        // they are seeded
+        static constexpr bool valid(Handle) { return true; }
+        static const T& value(Handle h) { return h->data; }
+        static size_t childCount(Handle h) { return h->childCount(); }
+        static Handle child(Handle h, size_t i) { return h->child(i); }
+        static constexpr bool hasId = true;
+        static size_t id(Handle h) { return h->id(); }
+    };
+
+    // One per worker, padded so accumulating results never shares a cache line
+    template <typename U>
+    struct alignas(64) PerWorker {
+        U value{};
+    };
+
+    // A seat's statistics for the current query. Only the job holding the
+    // seat writes them, with a plain load and store rather than a locked
+    // read-modify-write; anyone may read them (limit checks sum nodesVisited).
+    struct alignas(64) SeatCounters {
+        std::atomic<size_t> nodesVisited{0};
+        std::atomic<size_t> tasksSpawned{0};
+        std::atomic<size_t> tasksExecuted{0};
+        std::atomic<size_t> steals{0};
+        std::atomic<size_t> remoteSteals{0};
+        std::atomic<std::uint64_t> queueWaitNs{0};
+        std::atomic<std::uint64_t> idleNs{0};
+
+        void reset() {
+            nodesVisited.store(0, std::memory_order_relaxed);
+            tasksSpawned.store(0, std::memory_order_relaxed);
+            tasksExecuted.store(0, std::memory_order_relaxed);
+            steals.store(0, std::memory_order_relaxed);
+            remoteSteals.store(0, std::memory_order_relaxed);
+            queueWaitNs.store(0, std::memory_order_relaxed);
+            idleNs.store(0, std::memory_order_relaxed);
+        }
     };
 
+    template <typename U>
+    static void bump(std::atomic<U>& counter, U n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // bump() for counters only kept with Traits::stats
+    template <typename U>
+    static void tally(std::atomic<U>& counter, U n) {
+        if constexpr (Traits::stats) bump(counter, n);
+    }
+
+    using StatsClock = std::chrono::steady_clock;
+
+    static std::uint32_t stamp() {
+        if constexpr (!Traits::stats) return 0;
+        auto now = StatsClock::now().time_since_epoch();
+        return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    // One participant's seat in a query. A seat is occupied by at most one
+    // pool job at a time, which owns its deque and stack until it leaves.
+    struct alignas(64) Worker {
+        WorkStealingDeque<Task> deque;
+        // Explicit DFS stack reused across tasks and queries, so traversal
+        // depth is bounded by memory rather than the thread's stack
+        std::vector<Task> stack;
+        // Key interval still owned by the pointer-tree task being run
+        std::uint64_t keyLo = 0;
+        std::uint64_t keyHi = 0;
+        // Path tracking: the running task's parent chain and depth, the
+        // nodes from its start down to the one being visited, and each
+        // one's Trail once made (see pin); links holds the seat's Trails
+        const Trail* trailBase = nullptr;
+        int trailDepth = 0;
+        std::vector<Task> trail;
+        std::vector<const Trail*> trailLinks;
+        std::deque<Trail> links;
+        // Nodes left until the next poll, and nodes visited since the seat's job started
+        size_t untilPoll = LIMIT_CHECK_INTERVAL;
+        size_t slice = 0;
+        // Set by a poll that wants the thread back for other queued jobs
+        bool yielding = false;
+        std::atomic<bool> seated{false};
+        // NUMA node of the pool thread holding the seat, -1 if unknown
+        std::atomic<int> node{-1};
+        std::uint32_t rng;
+        SeatCounters counters;
+
+        explicit Worker(std::uint32_t seed) : rng(seed ? seed : 1u) {
+            stack.reserve(TRAVERSAL_STACK_RESERVE);
+        }
+
+        // xorshift32 for victim selection
+        std::uint32_t next() {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            return rng;
+        }
+    };
+
+    // Everything one in-flight query owns. Queries are recycled, so neither
+    // search() nor searchAsync() allocates seats once the searcher is warm.
+    struct Query {
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        // Only used to park idle workers and to wait for the query to finish
+        std::mutex mx;
+        std::condition_variable cv;
+        std::condition_variable doneCv;
+        std::atomic<std::uint64_t> wakeEpoch{0};
+        std::atomic<size_t> sleepers{0};
+        // Pool jobs running or queued for this query; the last one out completes it
+        size_t participants{0};
+        bool done{false};
+        // Seats given up by idle workers, refilled by push_task
+        std::atomic<size_t> vacant{0};
+
+        // Tasks seeded for whichever workers run on a given NUMA node (see
+        // seed); only stolen from, and only used by placed-tree queries
+        std::vector<std::unique_ptr<WorkStealingDeque<Task>>> homes;
+        bool homed{false};
+
+        std::atomic<bool> found{false};
+        std::atomic<size_t> inflight{0};
+
+        // Statistics beyond the per-seat counters: when the query was
+        // launched, how long it ran (set by the last participant out) and,
+        // once something matched, how long that took (-1 until then)
+        StatsClock::time_point launchedAt;
+        std::int64_t elapsedNs{0};
+        std::atomic<std::int64_t> firstMatchNs{-1};
+
+        // Workers that found nothing to pop or steal; read on the hot path by
+        // the adaptive policy, written only on idle transitions
+        alignas(64) std::atomic<size_t> hungry{0};
+
+        // TreeNode root tasks point here, which also keeps an async query's tree alive
+        std::shared_ptr<TreeNode<T>> root;
+        std::shared_ptr<TreeNode<T>> resultNode;
+        const ArenaTreeNode<T>* resultArenaNode{nullptr};
+        size_t resultIndex{FlatTree<T>::npos};
+
+        // Leftmost mode: a match no longer ends the query. Candidates are kept
+        // by DFS key and work to the right of the best one is pruned.
+        bool leftmost{false};
+        std::mutex resultMx;
+        alignas(64) std::atomic<std::uint64_t> bestKey{NoKey};
+
+        // Shallowest mode: the same, keeping candidates by depth instead.
+        // Nothing at or below the best one's depth can beat it, so all of
+        // that is pruned.
+        bool shallowest{false};
+        std::atomic<int> bestDepth{NoDepth};
+
+        // Path tracking: tasks carry Trails, and the result's is kept
+        bool paths{false};
+        const Trail* resultTrail{nullptr};
+
+        // Optional record of visited node ids
+        VisitEpochs* visits{nullptr};
+
+        // Optional bounds, and why they stopped the query (if they did)
+        SearchLimits bounds;
+        bool limited{false};
+        std::atomic<int> limitStop{-1};
+
+        // Runs one task; set up by the call that submits the query
+        std::function<void(size_t, const Task&)> run;
+        // Async queries only: called by the last participant to leave
+        std::function<void()> onComplete;
+        // Multi-round queries (breadth-first levels): called by the last
+        // participant to leave; true if it started another round instead
+        // of letting the query complete
+        std::function<bool()> nextRound;
+
+        explicit Query(size_t width) {
+            workers.reserve(width);
+            for (size_t i = 0; i < width; ++i)
+                workers.emplace_back(std::make_unique<Worker>(static_cast<std::uint32_t>(2654435761u * (i + 1))));
+        }
+    };
+
+    // Hands a synchronous call's Query back when it goes out of scope
+    struct QueryReturn {
+        ParallelTreeSearch* owner;
+        void operator()(Query* q) const {
+            owner->lastFound.store(q->found.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            owner->lastNodesVisited.store(visited(*q), std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lk(owner->statsMx);
+                collect(*q, owner->lastStats);
+            }
+            owner->release(*q);
+        }
+    };
+    using QueryLease = std::unique_ptr<Query, QueryReturn>;
+
     const size_t threadCount;
-    std::mutex mx;
-    std::condition_variable cv;
-    std::deque<Task> tasks;
-
-    std::atomic<bool> stop{false};
-    std::atomic<bool> found{false};
-    std::atomic<size_t> inflight{0};
-    std::atomic<size_t> nodesVisited{0};
-
-    std::shared_ptr<TreeNode<T>> resultNode{nullptr};
-    std::vector<std::thread> workers;
-
-    // Pop a task (LIFO for locality)
-    bool pop_task(Task& out) {
-        std::unique_lock<std::mutex> lk(mx);
-        if (tasks.empty()) return false;
-        out = std::move(tasks.back());
-        tasks.pop_back();
+    SplitPolicy policy;
+    MatchMode matchMode{MatchMode::Any};
+    TraversalOrder order{TraversalOrder::DepthFirst};
+
+    // Recycled queries; live counts those handed out and not yet returned
+    std::mutex queriesMx;
+    std::condition_variable queriesCv;
+    std::vector<std::unique_ptr<Query>> queries;
+    std::vector<Query*> idleQueries;
+    size_t liveQueries{0};
+
+    SplitMode split_mode() const {
+        if constexpr (Traits::fixedSplit) return Traits::split;
+        else return policy.mode;
+    }
+
+    // Outcome of the latest synchronous query, for isFound()/getNodesVisited()
+    std::atomic<bool> lastFound{false};
+    std::atomic<size_t> lastNodesVisited{0};
+    mutable std::mutex statsMx;
+    SearchStats lastStats;
+
+    // Workers live for the lifetime of the pool and are parked there between
+    // queries, so search() only pays for a wakeup. The pool is either our
+    // own or shared with other searchers; the value type plays no part in
+    // it, so every searcher uses the same ThreadPool<void> instantiation.
+    std::shared_ptr<ThreadPool<void>> pool;
+
+    Query& acquire(const SearchLimits* bounds) {
+        if constexpr (!Traits::limits) {
+            if (bounds && (bounds->cancel || bounds->hasDeadline() || bounds->maxNodes))
+                throw std::invalid_argument("ParallelTreeSearch built without SearchTraits::limits given SearchLimits");
+            bounds = nullptr;
+        }
+        Query* q;
+        {
+            std::lock_guard<std::mutex> lk(queriesMx);
+            if (idleQueries.empty()) {
+                queries.push_back(std::make_unique<Query>(threadCount));
+                idleQueries.push_back(queries.back().get());
+            }
+            q = idleQueries.back();
+            idleQueries.pop_back();
+            ++liveQueries;
+        }
+        q->found.store(false, std::memory_order_relaxed);
+        q->inflight.store(0, std::memory_order_relaxed);
+        q->launchedAt = StatsClock::now();
+        q->elapsedNs = 0;
+        q->firstMatchNs.store(-1, std::memory_order_relaxed);
+        q->hungry.store(0, std::memory_order_relaxed);
+        q->vacant.store(0, std::memory_order_relaxed);
+        if (q->homed) {
+            for (auto& home : q->homes) home->clear();
+            q->homed = false;
+        }
+        q->participants = 0;
+        q->done = false;
+        q->resultArenaNode = nullptr;
+        q->resultIndex = FlatTree<T>::npos;
+        q->leftmost = false;
+        q->bestKey.store(NoKey, std::memory_order_relaxed);
+        q->shallowest = false;
+        q->bestDepth.store(NoDepth, std::memory_order_relaxed);
+        q->paths = false;
+        q->resultTrail = nullptr;
+        q->visits = nullptr;
+        q->limited = bounds != nullptr;
+        if (bounds) q->bounds = *bounds;
+        q->limitStop.store(-1, std::memory_order_relaxed);
+        for (auto& w : q->workers) {
+            w->deque.clear();
+            w->untilPoll = LIMIT_CHECK_INTERVAL;
+            w->yielding = false;
+            w->seated.store(false, std::memory_order_relaxed);
+            w->counters.reset();
+            w->links.clear();
+        }
+        return *q;
+    }
+
+    QueryLease borrow(const SearchLimits* bounds = nullptr) {
+        return QueryLease(&acquire(bounds), QueryReturn{this});
+    }
+
+    // No worker is inside q when this runs
+    void release(Query& q) {
+        q.run = nullptr;
+        q.nextRound = nullptr;
+        q.root.reset();
+        q.resultNode.reset();
+        std::lock_guard<std::mutex> lk(queriesMx);
+        idleQueries.push_back(&q);
+        if (--liveQueries == 0) queriesCv.notify_all();
+    }
+
+    // Push a task onto the calling worker's own deque
+    void push_task(Query& q, size_t self, Task t) {
+        t.queuedAt = stamp();
+        tally<size_t>(q.workers[self]->counters.tasksSpawned, 1);
+        q.workers[self]->deque.push(t);
+        // Pairs with the fetch_add in park(): either we see the sleeper or it sees the task
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (q.sleepers.load(std::memory_order_relaxed) > 0) {
+            { std::lock_guard<std::mutex> lk(q.mx); q.wakeEpoch.fetch_add(1, std::memory_order_relaxed); }
+            q.cv.notify_one();
+        }
+        if (q.vacant.load(std::memory_order_relaxed) > 0) recruit(q);
+    }
+
+    // Steal the oldest task from another worker, nearest first: tasks homed
+    // on our NUMA node, then seats on our node, starting at a random victim.
+    // Other nodes' homes and seats are only tried once all of that is empty.
+    // Seats whose node is unknown count as near.
+    bool steal_task(Query& q, size_t self, Task& out) {
+        auto& w = *q.workers[self];
+        int node = w.node.load(std::memory_order_relaxed);
+        if (steal_near(q, self, node, true, out)) return true;
+        if (node < 0 || !steal_near(q, self, node, false, out)) return false;
+        tally<size_t>(w.counters.remoteSteals, 1);
         return true;
     }
 
-    // Push a task
-    void push_task(Task t) {
+    bool steal_near(Query& q, size_t self, int node, bool near, Task& out) {
+        auto isNear = [node](int other) { return node < 0 || other < 0 || other == node; };
+        if (q.homed) {
+            for (size_t h = 0; h < q.homes.size(); ++h)
+                if (isNear(static_cast<int>(h)) == near && q.homes[h]->steal(out)) return true;
+        }
+        if (threadCount < 2) return false;
+        size_t start = q.workers[self]->next() % threadCount;
+        for (size_t k = 0; k < threadCount; ++k) {
+            size_t victim = (start + k) % threadCount;
+            if (victim == self) continue;
+            auto& v = *q.workers[victim];
+            if (isNear(v.node.load(std::memory_order_relaxed)) == near && v.deque.steal(out)) return true;
+        }
+        return false;
+    }
+
+    bool has_queued_work(const Query& q) const {
+        for (auto& w : q.workers)
+            if (!w->deque.empty()) return true;
+        if (q.homed)
+            for (auto& home : q.homes)
+                if (!home->empty()) return true;
+        return false;
+    }
+
+    // Wake every parked worker (found, or last task retired)
+    void wake_all(Query& q) {
+        { std::lock_guard<std::mutex> lk(q.mx); q.wakeEpoch.fetch_add(1, std::memory_order_relaxed); }
+        q.cv.notify_all();
+    }
+
+    // Block until new work is pushed, the query is over, or the timeout
+    // passes (so a parked worker notices other queries queued on the pool)
+    void park(Query& q) {
+        std::uint64_t epoch = q.wakeEpoch.load(std::memory_order_acquire);
+        q.sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (!has_queued_work(q)) {
+            std::unique_lock<std::mutex> lk(q.mx);
+            q.cv.wait_for(lk, std::chrono::microseconds(PARK_TIMEOUT_US), [&]{
+                return q.wakeEpoch.load(std::memory_order_relaxed) != epoch ||
+                       q.found.load() || q.inflight.load() == 0;
+            });
+        }
+        q.sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Queue a pool job that works seat self of q until it leaves or yields
+    void enlist(Query& q, size_t self) {
+        pool->enqueue([this, &q, self]{ worker_loop(q, self); });
+    }
+
+    void launch(Query& q) {
+        q.launchedAt = StatsClock::now();
+        start_round(q);
+    }
+
+    // Seat every worker on q; for later rounds, once the previous one has
+    // drained and everyone has left
+    void start_round(Query& q) {
         {
-            std::lock_guard<std::mutex> lk(mx);
-            tasks.emplace_back(std::move(t));
+            std::lock_guard<std::mutex> lk(q.mx);
+            q.participants = threadCount;
+        }
+        q.vacant.store(0, std::memory_order_relaxed);
+        // One wakeup for the whole batch of participants
+        std::vector<InlineTask> jobs;
+        jobs.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            q.workers[i]->seated.store(true, std::memory_order_relaxed);
+            jobs.emplace_back([this, &q, i]{ worker_loop(q, i); });
         }
-        cv.notify_one();
+        pool->enqueueBatch(jobs.begin(), jobs.end());
     }
 
-    // Sequential DFS used at/after cutoff to avoid spawning tiny tasks
-    void sequential_search(const std::shared_ptr<TreeNode<T>>& node, int depth, const T& target) {
-        if (!node || found.load(std::memory_order_relaxed)) return;
-        nodesVisited.fetch_add(1, std::memory_order_relaxed);
-        if (node->data == target) {
-            resultNode = node;
-            found.store(true, std::memory_order_relaxed);
+    // Work showed up while some seats were vacant: fill one. The caller is
+    // a participant, so the query cannot complete underneath us.
+    void recruit(Query& q) {
+        for (size_t i = 0; i < threadCount; ++i) {
+            bool vacant = false;
+            auto& seat = q.workers[i]->seated;
+            if (seat.load(std::memory_order_relaxed) || !seat.compare_exchange_strong(vacant, true, std::memory_order_acq_rel))
+                continue;
+            q.vacant.fetch_sub(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lk(q.mx);
+                ++q.participants;
+            }
+            enlist(q, i);
             return;
         }
-        if (node->children.empty()) return;
-        for (auto& c : node->children) {
-            if (found.load(std::memory_order_relaxed)) return;
-            sequential_search(c, depth + 1, target);
+    }
+
+    // A participant is done with q; the last one out completes the query
+    void leave(Query& q) {
+        {
+            std::lock_guard<std::mutex> lk(q.mx);
+            if (--q.participants > 0) return;
+        }
+        if (q.nextRound && q.nextRound()) return;
+        std::function<void()> complete;
+        {
+            std::lock_guard<std::mutex> lk(q.mx);
+            q.elapsedNs = since_launch(q);
+            if (!q.onComplete) {
+                q.done = true;
+                q.doneCv.notify_all();
+                return;
+            }
+            complete = std::move(q.onComplete);
+            q.onComplete = nullptr;
         }
+        complete();
+    }
+
+    void wait(Query& q) {
+        std::unique_lock<std::mutex> lk(q.mx);
+        q.doneCv.wait(lk, [&]{ return q.done; });
+    }
+
+    void set_result(Query& q, const std::shared_ptr<TreeNode<T>>* node) { q.resultNode = *node; }
+    void set_result(Query& q, const ArenaTreeNode<T>* node) { q.resultArenaNode = node; }
+    void set_result(Query& q, size_t index) { q.resultIndex = index; }
+
+    static std::int64_t since_launch(const Query& q) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(StatsClock::now() - q.launchedAt).count();
+    }
+
+    // Time to first match, for the statistics
+    static void note_match(Query& q) {
+        if constexpr (!Traits::stats) return;
+        if (q.firstMatchNs.load(std::memory_order_relaxed) >= 0) return;
+        std::int64_t none = -1;
+        q.firstMatchNs.compare_exchange_strong(none, since_launch(q), std::memory_order_relaxed);
+    }
+
+    // Only the first match publishes; the rest see found and bail out.
+    // at is the match's Trail in path-tracking queries.
+    template <typename Handle>
+    void publish(Query& q, Handle node, const Trail* at = nullptr) {
+        if (!q.found.exchange(true, std::memory_order_acq_rel)) {
+            note_match(q);
+            set_result(q, node);
+            q.resultTrail = at;
+            wake_all(q);
+        }
+    }
+
+    // Leftmost mode: keep the candidate with the smallest DFS key
+    template <typename Handle>
+    void offer(Query& q, std::uint64_t key, Handle node, const Trail* at = nullptr) {
+        note_match(q);
+        std::lock_guard<std::mutex> lk(q.resultMx);
+        if (key < q.bestKey.load(std::memory_order_relaxed)) {
+            q.bestKey.store(key, std::memory_order_relaxed);
+            set_result(q, node);
+            q.resultTrail = at;
+        }
+    }
+
+    // Shallowest mode: keep the candidate with the smallest depth, which is
+    // the node the calling worker is visiting. A match at the root can't
+    // be beaten, so it ends the query.
+    template <typename Links>
+    void offer_depth(Query& q, size_t self) {
+        auto& w = *q.workers[self];
+        int depth = w.trail.back().depth;
+        if (too_deep(q, depth)) return;
+        const Trail* at = pin(w, w.trail.size() - 1);
+        note_match(q);
+        {
+            std::lock_guard<std::mutex> lk(q.resultMx);
+            if (depth >= q.bestDepth.load(std::memory_order_relaxed)) return;
+            q.bestDepth.store(depth, std::memory_order_relaxed);
+            q.resultTrail = at;
+            set_result(q, Links::get(at->frame));
+        }
+        if (depth == 0) finish(q);
+    }
+
+    // A match in the task the calling worker is running: the node it is
+    // visiting, so in path-tracking queries the end of its trail
+    template <typename Handle>
+    void report(Query& q, size_t self, Handle node) {
+        auto& w = *q.workers[self];
+        const Trail* at = q.paths ? pin(w, w.trail.size() - 1) : nullptr;
+        if (q.leftmost) offer(q, w.keyLo, node, at);
+        else publish(q, node, at);
+    }
+
+    // Leftmost mode: everything at or after key lies right of a known match
+    static bool pruned(const Query& q, std::uint64_t key) {
+        return q.leftmost && key > q.bestKey.load(std::memory_order_relaxed);
+    }
+
+    // End the query without a single result (e.g. every target retired)
+    void finish(Query& q) {
+        if (!q.found.exchange(true, std::memory_order_acq_rel)) wake_all(q);
+    }
+
+    // Stop the query on behalf of a limit; the first reason wins
+    void halt(Query& q, SearchStatus why) {
+        int none = -1;
+        q.limitStop.compare_exchange_strong(none, static_cast<int>(why), std::memory_order_relaxed);
+        finish(q);
+    }
+
+    // Which limit, if any, stops a query that has visited this many nodes
+    static std::optional<SearchStatus> limit_hit(const SearchLimits& limits, size_t visited) {
+        if (limits.cancel && limits.cancel->isCancelled()) return SearchStatus::Cancelled;
+        if (limits.maxNodes && visited >= limits.maxNodes) return SearchStatus::BudgetExceeded;
+        if (limits.hasDeadline() && SearchLimits::Clock::now() >= limits.deadline) return SearchStatus::TimedOut;
+        return std::nullopt;
+    }
+
+    // Nodes visited so far, summed over the seats
+    static size_t visited(const Query& q) {
+        size_t n = 0;
+        for (auto& w : q.workers) n += w->counters.nodesVisited.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    bool limits_reached(Query& q) {
+        auto why = limit_hit(q.bounds, visited(q));
+        if (!why) return false;
+        halt(q, *why);
+        return true;
+    }
+
+    // Count n nodes against the poll interval. True if the current task
+    // should stop: a limit ended the query, or (yielding set) the worker has
+    // used its time slice while other jobs wait for a pool thread.
+    bool tick(Query& q, size_t self, size_t n = 1) {
+        if constexpr (!Traits::limits) return false;
+        auto& w = *q.workers[self];
+        if (w.untilPoll > n) {
+            w.untilPoll -= n;
+            return false;
+        }
+        w.slice += LIMIT_CHECK_INTERVAL - w.untilPoll + n;
+        w.untilPoll = LIMIT_CHECK_INTERVAL;
+        if (q.limited && limits_reached(q)) return true;
+        if (w.slice >= QUERY_TIME_SLICE && pool->hasWaitingTasks()) {
+            w.yielding = true;
+            return true;
+        }
+        return false;
+    }
+
+    void spawn(Query& q, size_t self, const Task& task) {
+        q.inflight.fetch_add(1, std::memory_order_relaxed);
+        push_task(q, self, task);
+    }
+
+    // Adaptive policy: split only when someone is waiting and our own deque
+    // has nothing left for them to steal
+    bool should_split(const Query& q, size_t self) const {
+        return (split_mode() == SplitMode::Adaptive || q.leftmost) &&
+               q.hungry.load(std::memory_order_relaxed) > 0 &&
+               q.workers[self]->deque.empty();
+    }
+
+    // Spawn the oldest give frames of the explicit stack. Those frames are
+    // the shallowest pending subtrees, so thieves get big pieces; pushing
+    // them oldest first keeps our own LIFO pops in DFS order.
+    //
+    // The given frames all come after what we keep in DFS order, so we keep
+    // [keyLo, from) and deal [from, keyHi) out to them, nearest frame first.
+    // Once the interval is too narrow to share, leftmost mode refuses rather
+    // than lose the ordering.
+    bool hand_off(Query& q, size_t self, size_t give, std::uint64_t from) {
+        auto& w = *q.workers[self];
+        auto& stack = w.stack;
+
+        std::uint64_t piece = (w.keyHi - from) / give;
+        if (piece == 0 && q.leftmost) return false;
+
+        for (size_t i = 0; i < give; ++i) {
+            // stack[give - 1] is next in DFS order, stack[0] last
+            std::uint64_t rank = give - 1 - i;
+            Task t = stack[i];
+            t.lo = from + rank * piece;
+            t.hi = (rank == give - 1) ? w.keyHi : t.lo + piece;
+            if (q.paths) t.trail = parent_of(w, t);
+            spawn(q, self, t);
+        }
+        w.keyHi = from;
+        stack.erase(stack.begin(), stack.begin() + give);
+        return true;
+    }
+
+    // Path tracking: frame was just popped for a visit. Every frame still
+    // on the stack is a child of a node on the trail, so the trail is cut
+    // back to frame's parent first.
+    static void step(Worker& w, const Task& frame) {
+        size_t i = static_cast<size_t>(frame.depth - w.trailDepth);
+        w.trail.resize(i);
+        w.trailLinks.resize(i);
+        w.trail.push_back(frame);
+        w.trailLinks.push_back(nullptr);
     }
 
-    void worker_loop(const T& target) {
-        while (true) {
-            if (found.load(std::memory_order_relaxed)) {
-                // Drain: allow inflight to drop to 0
-                Task dummy;
-                if (inflight.load(std::memory_order_relaxed) == 0) break;
+    // Trail of the i-th node on the worker's trail, making it (and any
+    // ancestors still without one) if need be
+    static const Trail* pin(Worker& w, size_t i) {
+        size_t k = i + 1;
+        while (k > 0 && !w.trailLinks[k - 1]) --k;
+        for (; k <= i; ++k) {
+            w.links.push_back({w.trail[k], k ? w.trailLinks[k - 1] : w.trailBase});
+            w.trailLinks[k] = &w.links.back();
+        }
+        return w.trailLinks[i];
+    }
+
+    // Trail of a pending frame's parent
+    static const Trail* parent_of(Worker& w, const Task& frame) {
+        int i = frame.depth - w.trailDepth - 1;
+        return i < 0 ? w.trailBase : pin(w, static_cast<size_t>(i));
+    }
+
+    // Start the trail at the root of the task about to run
+    static void begin_trail(Worker& w, const Task& start) {
+        w.trailBase = start.trail;
+        w.trailDepth = start.depth;
+        w.trail.clear();
+        w.trailLinks.clear();
+    }
+
+    // Shallowest mode: nothing at depth can beat the best match so far
+    static bool too_deep(const Query& q, int depth) {
+        return q.shallowest && depth >= q.bestDepth.load(std::memory_order_relaxed);
+    }
+
+    // Give the older half of the stack to idle workers
+    void split_stack(Query& q, size_t self) {
+        auto& w = *q.workers[self];
+        std::uint64_t from = w.keyLo + (w.keyHi - w.keyLo) / 2;
+        // We keep going, so in leftmost mode our part may not be left empty:
+        // our matches would share a key with the thieves' and lose ties
+        if (from == w.keyLo && q.leftmost) return;
+        hand_off(q, self, w.stack.size() / 2, from);
+    }
+
+    // Yielding: park the whole stack in our deque, where this seat's next
+    // job (or a thief) picks it up again
+    bool spill(Query& q, size_t self) {
+        auto& w = *q.workers[self];
+        return hand_off(q, self, w.stack.size(), w.keyLo);
+    }
+
+    // Iterative DFS used at/after cutoff to avoid spawning tiny tasks.
+    // visit(self, node) inspects one node and returns true to stop.
+    template <typename Links, typename Visit>
+    void sequential_search(Query& q, size_t self, const Task& start, Visit& visit) {
+        auto& w = *q.workers[self];
+        auto& stack = w.stack;
+        stack.clear();
+        stack.push_back(start);
+        w.keyLo = start.lo;
+        w.keyHi = start.hi;
+        if (q.paths) begin_trail(w, start);
+        // Without limits nobody reads the count mid-task, so it stays in a register
+        size_t nodes = 0;
+
+        while (!stack.empty()) {
+            if (q.found.load(std::memory_order_relaxed) || pruned(q, w.keyLo)) break;
+            if (tick(q, self)) {
+                if (!w.yielding || spill(q, self)) break;
+                // Leftmost keys too narrow to spill: finish this task first
+                w.yielding = false;
             }
+            if (stack.size() > 1 && should_split(q, self)) split_stack(q, self);
 
-            Task task;
-            {
-                std::unique_lock<std::mutex> lk(mx);
-                cv.wait(lk, [&]{
-                    return stop.load() || found.load() || !tasks.empty();
-                });
-                if (stop.load()) break;
-                if (tasks.empty()) {
-                    if (found.load() && inflight.load()==0) break;
-                    else continue;
-                }
-                task = std::move(tasks.back());
-                tasks.pop_back();
+            Task frame = stack.back();
+            stack.pop_back();
+
+            auto node = Links::get(frame);
+            if (!Links::valid(node) || too_deep(q, frame.depth)) continue;
+            // Pruned subtrees are not counted as visited
+            if constexpr (requires { visit.skipSubtree(node); }) {
+                if (visit.skipSubtree(node)) continue;
+            }
+            if (q.paths) step(w, frame);
+            if constexpr (Traits::limits) bump<size_t>(w.counters.nodesVisited, 1);
+            else ++nodes;
+            if constexpr (Links::hasId) {
+                if (q.visits) q.visits->markVisited(Links::id(node));
+            }
+            if (visit(self, node)) break;
+            // Reverse order so children come off the stack left to right
+            for (size_t j = Links::childCount(node); j-- > 0;)
+                stack.push_back(Links::make(Links::child(node, j), frame.depth + 1));
+        }
+        stack.clear();
+        if constexpr (!Traits::limits) bump(w.counters.nodesVisited, nodes);
+    }
+
+    template <typename Links, typename Visit>
+    void run_task(Query& q, size_t self, const Task& task, Visit& visit) {
+        auto node = Links::get(task);
+        if (!Links::valid(node) || too_deep(q, task.depth)) return;
+
+        // Adaptive and leftmost: splitting happens on demand inside the traversal.
+        // Static at/after cutoff: run sequentially.
+        if (split_mode() == SplitMode::Adaptive || q.leftmost || task.depth >= policy.cutoffDepth) {
+            sequential_search<Links>(q, self, task, visit);
+            return;
+        }
+
+        if constexpr (requires { visit.skipSubtree(node); }) {
+            if (visit.skipSubtree(node)) return;
+        }
+        if (tick(q, self)) {
+            // Not started yet, so yielding just requeues the task
+            if (q.workers[self]->yielding) spawn(q, self, task);
+            return;
+        }
+        auto& w = *q.workers[self];
+        if (q.paths) {
+            begin_trail(w, task);
+            step(w, task);
+        }
+        bump<size_t>(w.counters.nodesVisited, 1);
+        if constexpr (Links::hasId) {
+            if (q.visits) q.visits->markVisited(Links::id(node));
+        }
+        if (visit(self, node)) return;
+
+        // Below cutoff: spawn limited parallelism; rest sequential
+        const Trail* parent = q.paths ? pin(w, 0) : nullptr;
+        size_t spawned = 0;
+        for (size_t i = 0; i < Links::childCount(node); ++i) {
+            if (q.found.load(std::memory_order_relaxed)) break;
+            Task child = Links::make(Links::child(node, i), task.depth + 1);
+            child.trail = parent;
+            if (spawned < policy.maxParChildren) {
+                spawn(q, self, child);
+                ++spawned;
+            } else {
+                // Keep the remaining children local; idle workers steal the spawned ones
+                sequential_search<Links>(q, self, child, visit);
             }
+        }
+    }
+
+    // Scan a preorder range block by block. In adaptive mode the upper half
+    // is given away whenever a worker is idle and the range is worth halving.
+    // visitBlock(self, begin, len, scanned) inspects [begin, begin + len),
+    // sets scanned to the number of nodes it looked at and returns true to stop.
+    template <typename VisitBlock>
+    void run_range(Query& q, size_t self, const Task& task, VisitBlock& visitBlock, size_t block = FLAT_SCAN_BLOCK) {
+        size_t b = task.lo, e = task.hi;
+
+        while (b < e) {
+            if (q.found.load(std::memory_order_relaxed) || pruned(q, b)) return;
+
+            if (e - b > 2 * block && should_split(q, self)) {
+                size_t mid = b + (e - b) / 2;
+                spawn(q, self, Task::range(mid, e));
+                e = mid;
+            }
+
+            size_t len = std::min(e, b + block) - b;
+            size_t scanned = len;
+            bool stop = visitBlock(self, b, len, scanned);
+            bump(q.workers[self]->counters.nodesVisited, scanned);
+            if (stop) return;
+            b += len;
+            if (tick(q, self, scanned)) {
+                if (q.workers[self]->yielding && b < e) spawn(q, self, Task::range(b, e));
+                return;
+            }
+        }
+    }
+
+    // One pool job working seat self of q. It leaves when the query is
+    // over, when its slice is up and other jobs are queued (requeueing
+    // itself behind them), or when it is idle and the thread is wanted
+    // elsewhere (giving up the seat until push_task refills it).
+    void worker_loop(Query& q, size_t self) {
+        auto& w = *q.workers[self];
+        w.node.store(currentNumaNode(), std::memory_order_relaxed);
+        size_t idleRounds = 0;
+        bool idle = false;
+        StatsClock::time_point idleSince;
+        auto stopIdling = [&] {
+            q.hungry.fetch_sub(1, std::memory_order_relaxed);
+            idle = false;
+            if constexpr (Traits::stats)
+                bump<std::uint64_t>(w.counters.idleNs, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                           StatsClock::now() - idleSince).count());
+        };
+        w.slice = 0;
 
-            // Execute task
-            if (found.load(std::memory_order_relaxed)) {
-                if (inflight.fetch_sub(1, std::memory_order_relaxed) == 1) {
-                    cv.notify_all();
+        while (!q.found.load(std::memory_order_relaxed)) {
+            Task task;
+            bool own = w.deque.pop(task);
+            if (own || steal_task(q, self, task)) {
+                if (idle) stopIdling();
+                idleRounds = 0;
+                tally<size_t>(w.counters.tasksExecuted, 1);
+                if (!own) tally<size_t>(w.counters.steals, 1);
+                tally<std::uint64_t>(w.counters.queueWaitNs, static_cast<std::uint32_t>(stamp() - task.queuedAt));
+                q.run(self, task);
+                if (q.inflight.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    // Last task finished; wake any parked workers
+                    wake_all(q);
+                }
+                if (w.yielding) {
+                    w.yielding = false;
+                    enlist(q, self);
+                    return;
                 }
                 continue;
             }
 
-            auto node = task.node;
-            if (node) {
-                nodesVisited.fetch_add(1, std::memory_order_relaxed);
-                if (node->data == target) {
-                    resultNode = node;
-                    found.store(true, std::memory_order_relaxed);
-                } else if (!node->children.empty()) {
-                    // If below cutoff: spawn limited parallelism; rest sequential
-                    if (task.depth < PAR_CUTOFF_DEPTH) {
-                        size_t spawned = 0;
-                        for (size_t i = 0; i < node->children.size(); ++i) {
-                            if (found.load(std::memory_order_relaxed)) break;
-                            auto& child = node->children[i];
-                            if (spawned < MAX_PAR_CHILDREN) {
-                                inflight.fetch_add(1, std::memory_order_relaxed);
-                                push_task(Task{child, task.depth + 1});
-                                ++spawned;
-                            } else {
-                                // Process remaining children sequentially to reduce queue pressure
-                                sequential_search(child, task.depth + 1, target);
-                                if (found.load(std::memory_order_relaxed)) break;
-                            }
-                        }
-                    } else {
-                        // At/after cutoff: run sequentially
-                        sequential_search(node, task.depth, target);
-                    }
+            // Nothing to run anywhere and nothing running: tree is drained
+            if (q.inflight.load(std::memory_order_acquire) == 0) break;
+
+            if (!idle) {
+                q.hungry.fetch_add(1, std::memory_order_relaxed);
+                idle = true;
+                if constexpr (Traits::stats) idleSince = StatsClock::now();
+            }
+            if (++idleRounds < STEAL_SPIN_ROUNDS) {
+                std::this_thread::yield();
+            } else if (pool->hasWaitingTasks()) {
+                // Whoever holds the remaining work is still seated, so the
+                // query cannot complete without us
+                stopIdling();
+                w.seated.store(false, std::memory_order_release);
+                q.vacant.fetch_add(1, std::memory_order_seq_cst);
+                leave(q);
+                return;
+            } else {
+                park(q);
+                idleRounds = 0;
+            }
+        }
+
+        if (idle) stopIdling();
+        leave(q);
+    }
+
+    static bool is_match(const std::shared_ptr<TreeNode<T>>& node) { return node != nullptr; }
+    static bool is_match(const ArenaTreeNode<T>* node) { return node != nullptr; }
+    static bool is_match(size_t index) { return index != FlatTree<T>::npos; }
+
+    // The finished query's single result, and how it ended
+    template <typename R>
+    SearchResult<R> outcome(Query& q) {
+        R match;
+        if constexpr (std::is_same_v<R, std::shared_ptr<TreeNode<T>>>) match = q.resultNode;
+        else if constexpr (std::is_same_v<R, const ArenaTreeNode<T>*>) match = q.resultArenaNode;
+        else match = q.resultIndex;
+
+        bool matched = is_match(match);
+        int stop = q.limitStop.load(std::memory_order_relaxed);
+        SearchStatus status;
+        if (stop >= 0 && (q.leftmost || q.shallowest || !matched)) status = static_cast<SearchStatus>(stop);
+        else status = matched ? SearchStatus::Found : SearchStatus::Exhausted;
+        q.found.store(matched, std::memory_order_relaxed);
+        SearchResult<R> result{match, status, visited(q), {}};
+        collect(q, result.stats);
+        return result;
+    }
+
+    // Sum up a finished query's seat counters into out, reusing its storage
+    static void collect(const Query& q, SearchStats& out) {
+        out.workers.resize(q.workers.size());
+        out.total = WorkerStats{};
+        for (size_t i = 0; i < q.workers.size(); ++i) {
+            const SeatCounters& c = q.workers[i]->counters;
+            WorkerStats& w = out.workers[i];
+            w.nodesVisited = c.nodesVisited.load(std::memory_order_relaxed);
+            w.tasksSpawned = c.tasksSpawned.load(std::memory_order_relaxed);
+            w.tasksExecuted = c.tasksExecuted.load(std::memory_order_relaxed);
+            w.steals = c.steals.load(std::memory_order_relaxed);
+            w.remoteSteals = c.remoteSteals.load(std::memory_order_relaxed);
+            w.queueWait = std::chrono::nanoseconds(c.queueWaitNs.load(std::memory_order_relaxed));
+            w.idle = std::chrono::nanoseconds(c.idleNs.load(std::memory_order_relaxed));
+            out.total += w;
+        }
+        out.elapsed = std::chrono::nanoseconds(q.elapsedNs);
+        std::int64_t first = q.firstMatchNs.load(std::memory_order_relaxed);
+        if (first >= 0) out.timeToFirstMatch = std::chrono::nanoseconds(first);
+        else out.timeToFirstMatch.reset();
+    }
+
+    // Claim target slot k for the calling worker; true once every target is found
+    template <typename Record>
+    bool retire(Query& q, TargetSet<T>& set, size_t k, Record record) {
+        if (k == TargetSet<T>::npos || !set.claim(k)) return false;
+        note_match(q);
+        record(k);
+        if (!set.resolved()) return false;
+        finish(q);
+        return true;
+    }
+
+    // Seed the first task on worker 0; the others start by stealing. With
+    // a home node the task waits in that node's home queue instead, for the
+    // first worker on the node to take. Seeding happens before launch, so
+    // the caller may push to deques it doesn't own.
+    void seed(Query& q, Task task, int home = -1, size_t seat = 0) {
+        q.inflight.fetch_add(1, std::memory_order_relaxed);
+        task.queuedAt = stamp();
+        tally<size_t>(q.workers[seat]->counters.tasksSpawned, 1);
+        if (home < 0) {
+            q.workers[seat]->deque.push(task);
+            return;
+        }
+        while (q.homes.size() <= static_cast<size_t>(home))
+            q.homes.push_back(std::make_unique<WorkStealingDeque<Task>>());
+        q.homed = true;
+        q.homes[home]->push(task);
+    }
+
+    void seed_flat(Query& q, size_t begin, size_t end, int home = -1, size_t block = FLAT_SCAN_BLOCK) {
+        if (split_mode() == SplitMode::Adaptive) {
+            seed(q, Task::range(begin, end), home);
+            return;
+        }
+        // No on-demand splitting: cut the range into a few chunks per worker up front
+        size_t size = end - begin;
+        size_t chunks = threadCount * 4;
+        size_t chunk = std::max<size_t>(block, (size + chunks - 1) / chunks);
+        if (home >= 0) {
+            // Home queues are only stolen from, oldest first
+            for (size_t b = begin; b < end; b += chunk)
+                seed(q, Task::range(b, std::min(end, b + chunk)), home);
+            return;
+        }
+        // Push back to front so worker 0 pops the leftmost chunk first
+        size_t last = begin + (size - 1) / chunk * chunk;
+        for (size_t b = last + chunk; b > begin; b -= chunk)
+            seed(q, Task::range(b - chunk, std::min(end, b)));
+    }
+
+    // Run a pointer-tree query from root and wait for it; workers call
+    // visit on every node, and visit lives on the caller's stack
+    template <typename Links, typename Visit>
+    void traverse(Query& q, typename Links::Handle root, Visit& visit) {
+        seed(q, Links::root(root));
+        q.run = [this, &q, &visit](size_t self, const Task& task) { run_task<Links>(q, self, task, visit); };
+        launch(q);
+        wait(q);
+    }
+
+    // Run a FlatTree query and wait for it; workers call visitBlock on every block of the array
+    template <typename VisitBlock>
+    void scan(Query& q, const FlatTree<T>& tree, VisitBlock& visitBlock) {
+        seed_flat(q, 0, tree.size());
+        q.run = [this, &q, &visitBlock](size_t self, const Task& task) { run_range(q, self, task, visitBlock); };
+        launch(q);
+        wait(q);
+    }
+
+    // Merge per-worker result buffers after the query; no locking on the way in
+    template <typename U>
+    static std::vector<U> merge(std::vector<PerWorker<std::vector<U>>>& buffers) {
+        size_t total = 0;
+        for (auto& b : buffers) total += b.value.size();
+        std::vector<U> out;
+        out.reserve(total);
+        for (auto& b : buffers)
+            for (auto& item : b.value) out.push_back(std::move(item));
+        return out;
+    }
+
+    // Index builds: every worker files the values it visits into its own
+    // map per hash partition, so nothing is shared until the merge
+    template <typename Ref>
+    using IndexShards = std::vector<PerWorker<std::vector<typename ValueIndex<T, Ref>::Partition>>>;
+
+    template <typename Ref>
+    IndexShards<Ref> index_shards(size_t partitions) {
+        IndexShards<Ref> shards(threadCount);
+        for (auto& shard : shards) shard.value.resize(partitions);
+        return shards;
+    }
+
+    // Add (value, entry) to part; a repeat keeps prefer(kept, new) and is no longer unique
+    template <typename Ref, typename Prefer>
+    static void file_entry(typename ValueIndex<T, Ref>::Partition& part, const T& value,
+                           const typename ValueIndex<T, Ref>::Entry& entry, Prefer& prefer) {
+        auto [it, inserted] = part.try_emplace(value, entry);
+        if (inserted) return;
+        it->second.unique = false;
+        it->second.ref = prefer(it->second.ref, entry.ref);
+    }
+
+    // Run job(0) .. job(n - 1) on the pool and wait for all of them
+    template <typename Job>
+    void run_all(size_t n, Job& job) {
+        std::latch finished(static_cast<std::ptrdiff_t>(n));
+        std::vector<InlineTask> jobs;
+        jobs.reserve(n);
+        for (size_t k = 0; k < n; ++k) {
+            jobs.emplace_back([&job, &finished, k] {
+                job(k);
+                finished.count_down();
+            });
+        }
+        pool->enqueueBatch(jobs.begin(), jobs.end());
+        finished.wait();
+    }
+
+    // One pool job per partition folds every worker's shard of it into index
+    template <typename Ref, typename Prefer>
+    void merge_index(ValueIndex<T, Ref>& index, IndexShards<Ref>& shards, Prefer prefer) {
+        auto mergePartition = [&index, &shards, &prefer](size_t p) {
+            auto& out = index.parts[p];
+            for (auto& shard : shards) {
+                auto& in = shard.value[p];
+                if (out.empty()) {
+                    out = std::move(in);
+                    continue;
                 }
+                for (const auto& [value, entry] : in) file_entry<Ref>(out, value, entry, prefer);
             }
+        };
+        run_all(index.parts.size(), mergePartition);
+    }
 
-            if (inflight.fetch_sub(1, std::memory_order_relaxed) == 1) {
-                // Last task finished; wake any waiters
-                cv.notify_all();
+    // Node i's summary from its own value and its children's (already final) summaries
+    static void summarize_node(SubtreeSummary<T>& summary, const FlatTree<T>& tree, size_t i) {
+        summary.set(i, tree.value(i));
+        size_t c = i + 1;
+        for (size_t k = 0; k < tree.childCount(i); ++k) {
+            summary.include(i, c);
+            c += tree.subtreeSize(c);
+        }
+    }
+
+    static void summarize_node(SubtreeSummary<T>& summary, const ArenaTreeNode<T>* node) {
+        summary.set(node->id(), node->data);
+        for (const ArenaTreeNode<T>* c : *node) summary.include(node->id(), c->id());
+    }
+
+    // Set q up as a findFirst over a pointer tree. Everything the workers
+    // need is copied into q.run, so the query can outlive the caller's frame.
+    template <typename Links, typename Pred>
+    void bind_first(Query& q, typename Links::Handle root, Pred pred) {
+        q.leftmost = matchMode == MatchMode::Leftmost;
+        // Levels keep no parents, so path-tracking queries stay depth-first
+        if (order != TraversalOrder::DepthFirst && !q.paths) {
+            bind_levels<Links>(q, root, std::move(pred));
+            return;
+        }
+        seed(q, Links::root(root));
+        bind_depth_first<Links>(q, pred);
+    }
+
+    template <typename Links, typename Pred>
+    void bind_depth_first(Query& q, const Pred& pred) {
+        q.run = [this, &q, pred](size_t self, const Task& task) {
+            auto visit = [this, &q, &pred](size_t s, typename Links::Handle node) {
+                if (!pred(Links::value(node))) return false;
+                report(q, s, node);
+                return true;
+            };
+            run_task<Links>(q, self, task, visit);
+        };
+    }
+
+    // A breadth-first or hybrid query's frontier. Each round of the query
+    // scans one level; workers append the children of a block of frontier
+    // nodes to their own buffer, noting where in the frontier the block
+    // began, so the next level can be put back in order without locking.
+    template <typename Links>
+    struct Levels {
+        using Handle = typename Links::Handle;
+        struct Block {
+            size_t begin;
+            size_t from;
+        };
+
+        std::vector<Handle> frontier;
+        std::vector<Handle> spare;
+        std::vector<PerWorker<std::vector<Handle>>> next;
+        std::vector<PerWorker<std::vector<Block>>> blocks;
+        int depth = 0;
+        bool depthFirst = false;
+
+        explicit Levels(size_t workers) : next(workers), blocks(workers) {}
+
+        // Concatenate the workers' buffers in frontier order
+        void advance() {
+            struct Piece {
+                size_t begin;
+                const Handle* first;
+                const Handle* last;
+            };
+            std::vector<Piece> pieces;
+            size_t total = 0;
+            for (size_t w = 0; w < next.size(); ++w) {
+                auto& buffer = next[w].value;
+                auto& marks = blocks[w].value;
+                for (size_t k = 0; k < marks.size(); ++k) {
+                    size_t to = k + 1 < marks.size() ? marks[k + 1].from : buffer.size();
+                    pieces.push_back({marks[k].begin, buffer.data() + marks[k].from, buffer.data() + to});
+                }
+                total += buffer.size();
             }
+            std::sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) { return a.begin < b.begin; });
+            spare.clear();
+            spare.reserve(total);
+            for (const Piece& piece : pieces) spare.insert(spare.end(), piece.first, piece.last);
+            frontier.swap(spare);
+            for (auto& buffer : next) buffer.value.clear();
+            for (auto& marks : blocks) marks.value.clear();
+            ++depth;
         }
+
+        size_t projected() const {
+            size_t n = 0;
+            for (Handle h : frontier) n += Links::childCount(h);
+            return n;
+        }
+    };
+
+    // Breadth-first and hybrid queries: start with the root as the frontier
+    template <typename Links, typename Pred>
+    void bind_levels(Query& q, typename Links::Handle root, Pred pred) {
+        auto levels = std::make_shared<Levels<Links>>(threadCount);
+        levels->frontier.push_back(root);
+        q.run = [this, &q, levels, pred](size_t self, const Task& task) {
+            auto visitBlock = [this, &q, &levels, &pred](size_t s, size_t b, size_t len, size_t& scanned) {
+                auto& next = levels->next[s].value;
+                levels->blocks[s].value.push_back({b, next.size()});
+                for (size_t i = 0; i < len; ++i) {
+                    auto node = levels->frontier[b + i];
+                    if constexpr (Links::hasId) {
+                        if (q.visits) q.visits->markVisited(Links::id(node));
+                    }
+                    if (pred(Links::value(node))) {
+                        scanned = i + 1;
+                        // Keys within a level are frontier indices, i.e. BFS order
+                        if (q.leftmost) offer(q, b + i, node);
+                        else publish(q, node);
+                        return true;
+                    }
+                    for (size_t j = 0; j < Links::childCount(node); ++j) {
+                        auto child = Links::child(node, j);
+                        if (Links::valid(child)) next.push_back(child);
+                    }
+                }
+                return false;
+            };
+            run_range(q, self, task, visitBlock, LEVEL_SCAN_BLOCK);
+        };
+        q.nextRound = [this, &q, levels, pred] {
+            if (levels->depthFirst || q.found.load(std::memory_order_relaxed) ||
+                q.bestKey.load(std::memory_order_relaxed) != NoKey)
+                return false;
+            levels->advance();
+            if (levels->frontier.empty()) return false;
+            seed_level<Links>(q, *levels, pred);
+            start_round(q);
+            return true;
+        };
+        seed_level<Links>(q, *levels, pred);
+    }
+
+    // Queue the frontier as the next round: one more level, or (hybrid,
+    // once there is enough of it) a depth-first task per frontier node,
+    // dealt round-robin so each seat starts on its leftmost one
+    template <typename Links, typename Pred>
+    void seed_level(Query& q, Levels<Links>& levels, const Pred& pred) {
+        size_t n = levels.frontier.size();
+        bool wide = order == TraversalOrder::Hybrid &&
+                    (n >= HYBRID_FRONTIER_PER_WORKER * threadCount || levels.projected() > HYBRID_MAX_FRONTIER);
+        if (!wide) {
+            seed_flat(q, 0, n, -1, LEVEL_SCAN_BLOCK);
+            return;
+        }
+        levels.depthFirst = true;
+        bind_depth_first<Links>(q, pred);
+        // Frontier order is DFS order across its subtrees, so they split
+        // the key space in frontier order
+        std::uint64_t piece = NoKey / n;
+        for (size_t j = n; j-- > 0;) {
+            Task t = Links::make(levels.frontier[j], levels.depth);
+            t.lo = j * piece;
+            t.hi = j + 1 == n ? NoKey : t.lo + piece;
+            seed(q, t, -1, j % threadCount);
+        }
+    }
+
+    // Shallowest queries: a depth-first search that keeps going after a
+    // match, pruned below the best depth so far, with paths tracked
+    template <typename Links, typename Pred>
+    void bind_shallowest(Query& q, typename Links::Handle root, Pred pred) {
+        q.shallowest = true;
+        q.paths = true;
+        seed(q, Links::root(root));
+        q.run = [this, &q, pred](size_t self, const Task& task) {
+            auto visit = [this, &q, &pred](size_t s, typename Links::Handle node) {
+                if (pred(Links::value(node))) offer_depth<Links>(q, s);
+                return false;
+            };
+            run_task<Links>(q, self, task, visit);
+        };
+    }
+
+    bool bind(Query& q, const std::shared_ptr<TreeNode<T>>& root, auto pred) {
+        if (!root) return false;
+        q.root = root;
+        bind_first<SharedLinks>(q, &q.root, std::move(pred));
+        return true;
+    }
+
+    bool bind(Query& q, const ArenaTree<T>& tree, auto pred) {
+        if (!tree.root()) return false;
+        bind_first<ArenaLinks>(q, tree.root(), std::move(pred));
+        return true;
+    }
+
+    // Flat findFirst/search: locate(b, len) finds a match inside one block, or returns len
+    template <typename Locate>
+    bool bind_flat(Query& q, const FlatTree<T>& tree, Locate locate) {
+        return bind_range(q, 0, tree.size(), std::move(locate));
+    }
+
+    // As bind_flat, over preorder indices [begin, end) only
+    template <typename Locate>
+    bool bind_range(Query& q, size_t begin, size_t end, Locate locate) {
+        if (begin >= end) return false;
+        seed_flat(q, begin, end);
+        bind_locate(q, std::move(locate));
+        return true;
+    }
+
+    // As bind_flat, with each slice seeded on the NUMA node that holds it
+    template <typename Locate>
+    bool bind_placed(Query& q, const NumaFlatTree<T>& tree, Locate locate) {
+        if (tree.empty()) return false;
+        for (const NumaSlice& slice : tree.slices())
+            if (slice.begin < slice.end) seed_flat(q, slice.begin, slice.end, slice.node);
+        bind_locate(q, std::move(locate));
+        return true;
+    }
+
+    template <typename Locate>
+    void bind_locate(Query& q, Locate locate) {
+        q.leftmost = matchMode == MatchMode::Leftmost;
+        q.run = [this, &q, locate](size_t self, const Task& task) {
+            auto visitBlock = [this, &q, &locate](size_t, size_t b, size_t len, size_t& scanned) {
+                size_t hit = locate(b, len);
+                if (hit == len) return false;
+                scanned = hit + 1;
+                if (q.leftmost) offer(q, b + hit, b + hit);
+                else publish(q, b + hit);
+                return true;
+            };
+            run_range(q, self, task, visitBlock);
+        };
+    }
+
+    bool bind(Query& q, const FlatTree<T>& tree, auto pred) {
+        const T* values = tree.data();
+        return bind_flat(q, tree, [values, pred](size_t b, size_t len) {
+            for (size_t i = 0; i < len; ++i)
+                if (pred(values[b + i])) return i;
+            return len;
+        });
+    }
+
+    bool bind_target(Query& q, const FlatTree<T>& tree, const T& target) {
+        const T* values = tree.data();
+        return bind_flat(q, tree, [values, target](size_t b, size_t len) {
+            return simdFindFirst(values + b, len, target);
+        });
+    }
+
+    // A visit that can also rule out a node's whole subtree before visiting
+    // it; sequential_search and run_task ask skipSubtree first
+    template <typename Visit, typename Skip>
+    struct PruningVisit {
+        Visit visit;
+        Skip skip;
+
+        template <typename Handle>
+        bool operator()(size_t self, Handle node) { return visit(self, node); }
+
+        template <typename Handle>
+        bool skipSubtree(Handle node) { return skip(node); }
+    };
+
+    // findFirst over an ArenaTree that skips subtree i (by id) unless
+    // admits(summary, i)
+    template <typename Admits, typename Pred>
+    bool bind_summarized(Query& q, const ArenaTree<T>& tree, const SubtreeSummary<T>& summary, Admits admits,
+                         Pred pred) {
+        if (!tree.root()) return false;
+        q.leftmost = matchMode == MatchMode::Leftmost;
+        seed(q, ArenaLinks::root(tree.root()));
+        q.run = [this, &q, &summary, admits, pred](size_t self, const Task& task) {
+            auto visit = [this, &q, &pred](size_t s, const ArenaTreeNode<T>* node) {
+                if (!pred(node->data)) return false;
+                report(q, s, node);
+                return true;
+            };
+            auto skip = [&summary, &admits](const ArenaTreeNode<T>* node) {
+                return !admits(summary, node->id());
+            };
+            PruningVisit<decltype(visit), decltype(skip)> pruning{visit, skip};
+            run_task<ArenaLinks>(q, self, task, pruning);
+        };
+        return true;
+    }
+
+    // The same over a FlatTree: a ruled-out node's subtree is a contiguous
+    // run of indices, so the block scan jumps past it, carrying on from
+    // there in later blocks of the task if the subtree outruns this one
+    template <typename Admits, typename Pred>
+    bool bind_summarized(Query& q, const FlatTree<T>& tree, const SubtreeSummary<T>& summary, Admits admits,
+                         Pred pred) {
+        if (tree.empty()) return false;
+        q.leftmost = matchMode == MatchMode::Leftmost;
+        seed_flat(q, 0, tree.size());
+        const T* values = tree.data();
+        const auto* sizes = tree.subtreeSizeData();
+        q.run = [this, &q, &summary, values, sizes, admits, pred](size_t self, const Task& task) {
+            size_t resume = task.lo;
+            auto visitBlock = [this, &q, &summary, values, sizes, &admits, &pred, &resume](size_t, size_t b, size_t len,
+                                                                                          size_t& scanned) {
+                scanned = 0;
+                size_t i = std::max(b, resume), end = b + len;
+                while (i < end) {
+                    if (!admits(summary, i)) {
+                        i += sizes[i];
+                        continue;
+                    }
+                    ++scanned;
+                    if (pred(values[i])) {
+                        if (q.leftmost) offer(q, i, i);
+                        else publish(q, i);
+                        return true;
+                    }
+                    ++i;
+                }
+                resume = i;
+                return false;
+            };
+            run_range(q, self, task, visitBlock);
+        };
+        return true;
+    }
+
+    // Latest-query outcome for a call answered without running a query
+    void record_lookup(bool found) {
+        lastFound.store(found, std::memory_order_relaxed);
+        lastNodesVisited.store(0, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lk(statsMx);
+        lastStats = SearchStats{};
+    }
+
+    // Run a bound single-result query to completion on the calling thread
+    template <typename R, typename Bind>
+    SearchResult<R> first(const SearchLimits* bounds, Bind bindQuery) {
+        QueryLease q = borrow(bounds);
+        if (bindQuery(*q)) {
+            launch(*q);
+            wait(*q);
+        }
+        return outcome<R>(*q);
+    }
+
+    // As first(), for a path-tracking query: the match and its recorded trail
+    template <typename Links, typename Bind>
+    MatchPath<typename Links::Result> first_path(Bind bindQuery) {
+        using R = typename Links::Result;
+        QueryLease q = borrow();
+        if (bindQuery(*q)) {
+            launch(*q);
+            wait(*q);
+        }
+        MatchPath<R> result;
+        result.match = outcome<R>(*q).match;
+        if (!is_match(result.match)) return result;
+        for (const Trail* t = q->resultTrail; t; t = t->parent) result.path.push_back(Links::result(Links::get(t->frame)));
+        std::reverse(result.path.begin(), result.path.end());
+        result.depth = static_cast<int>(result.path.size()) - 1;
+        return result;
+    }
+
+    static MatchPath<size_t> flat_path(const FlatTree<T>& tree, size_t match) {
+        MatchPath<size_t> result;
+        result.match = match;
+        if (match == FlatTree<T>::npos) return result;
+        result.path = tree.pathTo(match);
+        result.depth = static_cast<int>(result.path.size()) - 1;
+        return result;
+    }
+
+    // Start a bound single-result query and return without waiting; done
+    // gets the outcome on whichever thread finishes the query (the caller's,
+    // if there was nothing to search)
+    template <typename R, typename Bind, typename Done>
+    void submit(const SearchLimits& bounds, Bind bindQuery, Done done) {
+        Query& q = acquire(&bounds);
+        if (!bindQuery(q)) {
+            SearchResult<R> result = outcome<R>(q);
+            release(q);
+            done(std::move(result));
+            return;
+        }
+        q.onComplete = [this, &q, done]() mutable {
+            SearchResult<R> result = outcome<R>(q);
+            release(q);
+            done(std::move(result));
+        };
+        launch(q);
+    }
+
+    template <typename R, typename Bind>
+    std::future<SearchResult<R>> submit(const SearchLimits& bounds, Bind bindQuery) {
+        // std::function needs a copyable callback, so share the promise
+        auto promise = std::make_shared<std::promise<SearchResult<R>>>();
+        std::future<SearchResult<R>> result = promise->get_future();
+        submit<R>(bounds, std::move(bindQuery), [promise](SearchResult<R> r) { promise->set_value(std::move(r)); });
+        return result;
     }
 
 public:
-    explicit ParallelTreeSearch(size_t numThreads)
-        : threadCount(numThreads ? numThreads : 1) {}
+    // Starts a private pool of numThreads workers, optionally pinned to
+    // CPUs (see WorkerPinning); pinned workers steal within their NUMA node
+    // before reaching across to another
+    explicit ParallelTreeSearch(size_t numThreads, SplitPolicy splitPolicy = SplitPolicy{},
+                                WorkerPinning pinning = WorkerPinning::None)
+        : threadCount(numThreads ? numThreads : 1), policy(splitPolicy),
+          pool(std::make_shared<ThreadPool<void>>(threadCount, QueueBackend::Locked, pinning))
+    {
+    }
+
+    // Runs queries on sharedPool (e.g. ThreadPool<void>::shared()), each one
+    // using every pool thread. Queries from all searchers on the pool
+    // interleave as they do within one searcher, and a query that ends early
+    // only gives its threads back sooner. Synchronous calls must not be made
+    // from a job on the same pool.
+    explicit ParallelTreeSearch(std::shared_ptr<ThreadPool<void>> sharedPool, SplitPolicy splitPolicy = SplitPolicy{})
+        : threadCount(sharedPool->getThreadCount()), policy(splitPolicy), pool(std::move(sharedPool))
+    {
+    }
+
+    // Waits for outstanding searchAsync() queries; a shared pool lives on
+    ~ParallelTreeSearch() {
+        std::unique_lock<std::mutex> lk(queriesMx);
+        queriesCv.wait(lk, [&]{ return liveQueries == 0; });
+    }
 
     std::shared_ptr<TreeNode<T>> search(const std::shared_ptr<TreeNode<T>>& root, const T& target) {
-        // Reset state
-        found.store(false, std::memory_order_relaxed);
-        stop.store(false, std::memory_order_relaxed);
-        nodesVisited.store(0, std::memory_order_relaxed);
-        resultNode.reset();
-        inflight.store(0, std::memory_order_relaxed);
+        return findFirst(root, [&target](const T& v) { return v == target; });
+    }
+
+    const ArenaTreeNode<T>* search(const ArenaTree<T>& tree, const T& target) {
+        return findFirst(tree, [&target](const T& v) { return v == target; });
+    }
+
+    // Bounded searches: stop on cancellation, deadline or node budget,
+    // whichever comes first, and report which one ended the query
+    SearchResult<std::shared_ptr<TreeNode<T>>> search(const std::shared_ptr<TreeNode<T>>& root, const T& target,
+                                                      const SearchLimits& bounds) {
+        return first<std::shared_ptr<TreeNode<T>>>(&bounds, [&](Query& q) {
+            return bind(q, root, [&target](const T& v) { return v == target; });
+        });
+    }
+
+    SearchResult<const ArenaTreeNode<T>*> search(const ArenaTree<T>& tree, const T& target, const SearchLimits& bounds) {
+        return first<const ArenaTreeNode<T>*>(&bounds, [&](Query& q) {
+            return bind(q, tree, [&target](const T& v) { return v == target; });
+        });
+    }
+
+    SearchResult<size_t> search(const FlatTree<T>& tree, const T& target, const SearchLimits& bounds) {
+        return first<size_t>(&bounds, [&](Query& q) { return bind_target(q, tree, target); });
+    }
+
+    // As above, also stamping every visited node's id() into visitState,
+    // which must hold tree.size() entries. Starts a new epoch, so there is no
+    // reset pass between queries.
+    const ArenaTreeNode<T>* search(const ArenaTree<T>& tree, const T& target, VisitEpochs& visitState) {
+        if (visitState.size() < tree.size()) visitState.resize(tree.size());
+        visitState.beginEpoch();
+        return first<const ArenaTreeNode<T>*>(nullptr, [&](Query& q) {
+            q.visits = &visitState;
+            return bind(q, tree, [&target](const T& v) { return v == target; });
+        }).match;
+    }
+
+    // Returns the preorder index of a node holding target, or FlatTree<T>::npos
+    size_t search(const FlatTree<T>& tree, const T& target) {
+        return first<size_t>(nullptr, [&](Query& q) { return bind_target(q, tree, target); }).match;
+    }
+
+    // Over a tree from placeFlatTree: each slice starts out queued for the
+    // workers on its own NUMA node. Returns a preorder index into tree.tree().
+    size_t search(const NumaFlatTree<T>& tree, const T& target) {
+        const T* values = tree.tree().data();
+        return first<size_t>(nullptr, [&](Query& q) {
+            return bind_placed(q, tree, [values, target](size_t b, size_t len) {
+                return simdFindFirst(values + b, len, target);
+            });
+        }).match;
+    }
+
+    // Exact-match indexes, built in parallel by one traversal (see
+    // valueindex.hpp). Building costs about one findAll; afterwards
+    // search(index, target) is a hash lookup. A TreeIndex build also stamps
+    // each node with its worker's watch, which later addChild calls bump.
+    TreeIndex<T> buildIndex(const std::shared_ptr<TreeNode<T>>& root) {
+        using Node = std::shared_ptr<TreeNode<T>>;
+        TreeIndex<T> index;
+        index.watch(root, threadCount, threadCount);
+        if (!root) return index;
+
+        auto shards = index_shards<Node>(threadCount);
+        std::vector<PerWorker<typename TreeIndex<T>::Cover>> covers(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) covers[i].value.own = index.watched[i].watch.get();
+        auto keepFirst = [](const Node& kept, const Node&) { return kept; };
+        {
+            QueryLease q = borrow();
+            q->root = root;
+            auto visit = [this, &shards, &covers, &keepFirst](size_t self, typename SharedLinks::Handle node) {
+                TreeIndex<T>::cover(**node, covers[self].value);
+                const T& value = SharedLinks::value(node);
+                auto& part = shards[self].value[ValueIndex<T, Node>::partitionOf(value, threadCount)];
+                file_entry<Node>(part, value, {*node, true}, keepFirst);
+                return false;
+            };
+            traverse<SharedLinks>(*q, &q->root, visit);
+        }
+        merge_index(index, shards, keepFirst);
+        for (const auto& c : covers) index.adopt(c.value);
+        return index;
+    }
+
+    FlatIndex<T> buildIndex(const FlatTree<T>& tree) {
+        FlatIndex<T> index;
+        index.parts.resize(threadCount);
+        if (tree.empty()) return index;
+
+        auto shards = index_shards<size_t>(threadCount);
+        auto lowest = [](size_t kept, size_t other) { return std::min(kept, other); };
         {
-            std::lock_guard<std::mutex> lk(mx);
-            tasks.clear();
+            QueryLease q = borrow();
+            const T* values = tree.data();
+            auto visitBlock = [this, values, &shards, &lowest](size_t self, size_t b, size_t len, size_t&) {
+                auto& parts = shards[self].value;
+                for (size_t i = b; i < b + len; ++i)
+                    file_entry<size_t>(parts[FlatIndex<T>::partitionOf(values[i], threadCount)], values[i], {i, true}, lowest);
+                return false;
+            };
+            scan(*q, tree, visitBlock);
         }
+        merge_index(index, shards, lowest);
+        return index;
+    }
+
+    // A hash lookup while index is current. Falls back to an ordinary
+    // search of index.root() when it is stale, or when MatchMode::Leftmost
+    // wants the first of several nodes holding target. Predicate queries
+    // (findFirst, findAll, count) always traverse.
+    std::shared_ptr<TreeNode<T>> search(const TreeIndex<T>& index, const T& target) {
+        if (!index.current()) return search(index.root(), target);
+        const auto* entry = index.find(target);
+        if (entry && !entry->unique && matchMode == MatchMode::Leftmost) return search(index.root(), target);
+        record_lookup(entry != nullptr);
+        return entry ? entry->ref : nullptr;
+    }
 
-        if (!root) return nullptr;
+    // Lowest preorder index holding target, which is also the Leftmost answer, or npos
+    size_t search(const FlatIndex<T>& index, const T& target) {
+        const auto* entry = index.find(target);
+        record_lookup(entry != nullptr);
+        return entry ? entry->ref : FlatTree<T>::npos;
+    }
 
-        // Seed the first task
-        inflight.fetch_add(1, std::memory_order_relaxed);
-        push_task(Task{root, 0});
+    // Subtree min/max summaries (see subtreesummary.hpp), built bottom-up
+    // in parallel: subtrees small enough to be one job's work are
+    // summarized by pool jobs, then the nodes above them on this thread,
+    // children before parents.
+    SubtreeSummary<T> summarize(const FlatTree<T>& tree) {
+        SubtreeSummary<T> summary(tree.size());
+        if (tree.empty()) return summary;
 
-        // Start workers
-        workers.clear();
-        workers.reserve(threadCount);
-        for (size_t i = 0; i < threadCount; ++i) {
-            workers.emplace_back([this, &target]{
-                worker_loop(target);
+        size_t grain = std::max<size_t>(FLAT_SCAN_BLOCK, tree.size() / (4 * threadCount));
+        std::vector<size_t> top, subtrees, pending{0};
+        while (!pending.empty()) {
+            size_t i = pending.back();
+            pending.pop_back();
+            if (tree.subtreeSize(i) <= grain) {
+                subtrees.push_back(i);
+                continue;
+            }
+            top.push_back(i);
+            for (size_t c = i + 1, end = tree.subtreeEnd(i); c < end; c += tree.subtreeSize(c)) pending.push_back(c);
+        }
+
+        // A wide node can leave many small subtrees, so each job takes a slice of them
+        size_t jobs = std::min(subtrees.size(), 4 * threadCount);
+        auto job = [&](size_t k) {
+            for (size_t s = subtrees.size() * k / jobs, e = subtrees.size() * (k + 1) / jobs; s < e; ++s) {
+                size_t root = subtrees[s];
+                for (size_t i = tree.subtreeEnd(root); i-- > root;) summarize_node(summary, tree, i);
+            }
+        };
+        run_all(jobs, job);
+        for (size_t k = top.size(); k-- > 0;) summarize_node(summary, tree, top[k]);
+        return summary;
+    }
+
+    // Indexed by id(); the top levels are split off breadth-first until
+    // there are a few subtrees per worker
+    SubtreeSummary<T> summarize(const ArenaTree<T>& tree) {
+        using Node = const ArenaTreeNode<T>*;
+        SubtreeSummary<T> summary(tree.size());
+        if (!tree.root()) return summary;
+
+        size_t want = 4 * threadCount;
+        std::vector<Node> top, level{tree.root()};
+        while (level.size() < want) {
+            std::vector<Node> next;
+            bool expanded = false;
+            for (Node node : level) {
+                if (node->childCount() == 0) {
+                    next.push_back(node);
+                    continue;
+                }
+                top.push_back(node);
+                next.insert(next.end(), node->begin(), node->end());
+                expanded = true;
+            }
+            level = std::move(next);
+            if (!expanded) break;
+        }
+
+        size_t jobs = std::min(level.size(), want);
+        auto job = [&](size_t k) {
+            std::vector<Node> order, stack;
+            for (size_t s = level.size() * k / jobs, e = level.size() * (k + 1) / jobs; s < e; ++s) {
+                // Preorder, then backwards so every child is done before its parent
+                order.clear();
+                stack.push_back(level[s]);
+                while (!stack.empty()) {
+                    Node node = stack.back();
+                    stack.pop_back();
+                    order.push_back(node);
+                    stack.insert(stack.end(), node->begin(), node->end());
+                }
+                for (size_t i = order.size(); i-- > 0;) summarize_node(summary, order[i]);
+            }
+        };
+        run_all(jobs, job);
+        for (size_t k = top.size(); k-- > 0;) summarize_node(summary, top[k]);
+        return summary;
+    }
+
+    // Searches that skip every subtree whose summary rules the target out.
+    // summary must come from summarize(tree) and the tree must not have
+    // changed since; nodes skipped are not counted in getNodesVisited().
+    size_t search(const FlatTree<T>& tree, const SubtreeSummary<T>& summary, const T& target) {
+        auto admits = [target](const SubtreeSummary<T>& s, size_t i) { return s.mayContain(i, target); };
+        return first<size_t>(nullptr, [&](Query& q) {
+            return bind_summarized(q, tree, summary, admits, [&target](const T& v) { return v == target; });
+        }).match;
+    }
+
+    const ArenaTreeNode<T>* search(const ArenaTree<T>& tree, const SubtreeSummary<T>& summary, const T& target) {
+        auto admits = [target](const SubtreeSummary<T>& s, size_t i) { return s.mayContain(i, target); };
+        return first<const ArenaTreeNode<T>*>(nullptr, [&](Query& q) {
+            return bind_summarized(q, tree, summary, admits, [&target](const T& v) { return v == target; });
+        }).match;
+    }
+
+    // First node with lo <= value <= hi, chosen as findFirst would
+    size_t findInRange(const FlatTree<T>& tree, const SubtreeSummary<T>& summary, const T& lo, const T& hi) {
+        auto admits = [lo, hi](const SubtreeSummary<T>& s, size_t i) { return s.mayOverlap(i, lo, hi); };
+        return first<size_t>(nullptr, [&](Query& q) {
+            return bind_summarized(q, tree, summary, admits, [&lo, &hi](const T& v) { return !(v < lo) && !(hi < v); });
+        }).match;
+    }
+
+    const ArenaTreeNode<T>* findInRange(const ArenaTree<T>& tree, const SubtreeSummary<T>& summary, const T& lo, const T& hi) {
+        auto admits = [lo, hi](const SubtreeSummary<T>& s, size_t i) { return s.mayOverlap(i, lo, hi); };
+        return first<const ArenaTreeNode<T>*>(nullptr, [&](Query& q) {
+            return bind_summarized(q, tree, summary, admits, [&lo, &hi](const T& v) { return !(v < lo) && !(hi < v); });
+        }).match;
+    }
+
+    // Search a tree while it is still streaming in. Every STREAM_CHUNK_NODES
+    // nodes read become a query over just those nodes, which runs while the
+    // next chunk is read; the first chunk with a match ends the search and
+    // the rest of the stream is left unread (reader.take() returns what was
+    // loaded). Returns the match's preorder index. bounds cover the whole
+    // stream, but are only seen between reads: a reader blocked on its
+    // stream can't be cancelled.
+    SearchResult<size_t> searchStream(FlatTreeStreamReader<T>& reader, const T& target, const SearchLimits& bounds = {}) {
+        size_t visited = 0;
+        size_t searched = 0;
+        SearchStats stats;
+        std::future<SearchResult<size_t>> inflight;
+        std::optional<SearchResult<size_t>> stopped;
+
+        // Collect the chunk being searched; true once the search is over
+        auto settle = [&] {
+            if (!inflight.valid()) return false;
+            SearchResult<size_t> r = inflight.get();
+            visited += r.nodesVisited;
+            stats += r.stats;
+            if (r.status != SearchStatus::Exhausted) stopped = r;
+            return stopped.has_value();
+        };
+
+        while (!reader.done()) {
+            try {
+                // Growing moves the loaded nodes, so the chunk in flight has to finish first
+                if (reader.spare() == 0) {
+                    if (settle()) break;
+                    reader.grow(STREAM_CHUNK_NODES);
+                }
+                reader.readChunk(STREAM_CHUNK_NODES);
+            } catch (...) {
+                // The query in flight still reads the reader's arrays
+                if (inflight.valid()) inflight.wait();
+                throw;
+            }
+            if (settle()) break;
+            if (auto why = limit_hit(bounds, visited)) {
+                stopped = SearchResult<size_t>{FlatTree<T>::npos, *why, visited, {}};
+                break;
+            }
+
+            SearchLimits chunkBounds = bounds;
+            if (bounds.maxNodes) chunkBounds.maxNodes = bounds.maxNodes - visited;
+            const T* values = reader.data();
+            size_t begin = searched;
+            size_t end = reader.size();
+            searched = end;
+            inflight = submit<size_t>(chunkBounds, [this, values, begin, end, target](Query& q) {
+                return bind_range(q, begin, end, [values, target](size_t b, size_t len) {
+                    return simdFindFirst(values + b, len, target);
+                });
             });
         }
+        if (!stopped) settle();
 
-        // Wait until either found or inflight drains
+        SearchResult<size_t> result = stopped ? *stopped : SearchResult<size_t>{FlatTree<T>::npos, SearchStatus::Exhausted, 0, {}};
+        result.nodesVisited = visited;
+        result.stats = std::move(stats);
+        lastFound.store(result.match != FlatTree<T>::npos, std::memory_order_relaxed);
+        lastNodesVisited.store(visited, std::memory_order_relaxed);
         {
-            std::unique_lock<std::mutex> lk(mx);
-            cv.wait(lk, [&]{
-                return found.load() || inflight.load() == 0;
+            std::lock_guard<std::mutex> lk(statsMx);
+            lastStats = result.stats;
+        }
+        return result;
+    }
+
+    // Asynchronous searches: start the query on the pool and return at once.
+    // Queries in flight share the pool's threads; each participant gives its
+    // thread back every QUERY_TIME_SLICE nodes if other jobs are waiting, so
+    // a long search does not hold up the ones queued behind it. The searcher
+    // (and an ArenaTree or FlatTree passed by reference) must outlive the
+    // query; a TreeNode query holds a reference to its root.
+    std::future<SearchResult<std::shared_ptr<TreeNode<T>>>> searchAsync(std::shared_ptr<TreeNode<T>> root, T target,
+                                                                       const SearchLimits& bounds = {}) {
+        return submit<std::shared_ptr<TreeNode<T>>>(bounds, [this, root, target](Query& q) {
+            return bind(q, root, [target](const T& v) { return v == target; });
+        });
+    }
+
+    std::future<SearchResult<const ArenaTreeNode<T>*>> searchAsync(const ArenaTree<T>& tree, T target,
+                                                                  const SearchLimits& bounds = {}) {
+        return submit<const ArenaTreeNode<T>*>(bounds, [this, &tree, target](Query& q) {
+            return bind(q, tree, [target](const T& v) { return v == target; });
+        });
+    }
+
+    std::future<SearchResult<size_t>> searchAsync(const FlatTree<T>& tree, T target, const SearchLimits& bounds = {}) {
+        return submit<size_t>(bounds, [this, &tree, target](Query& q) { return bind_target(q, tree, target); });
+    }
+
+    // Callback flavour: done(SearchResult) runs on the pool thread that
+    // finishes the query, so it should be short and must not throw
+    template <typename Callback>
+        requires std::invocable<Callback&, SearchResult<std::shared_ptr<TreeNode<T>>>>
+    void searchAsync(std::shared_ptr<TreeNode<T>> root, T target, Callback done, const SearchLimits& bounds = {}) {
+        submit<std::shared_ptr<TreeNode<T>>>(bounds, [this, root, target](Query& q) {
+            return bind(q, root, [target](const T& v) { return v == target; });
+        }, std::move(done));
+    }
+
+    template <typename Callback>
+        requires std::invocable<Callback&, SearchResult<const ArenaTreeNode<T>*>>
+    void searchAsync(const ArenaTree<T>& tree, T target, Callback done, const SearchLimits& bounds = {}) {
+        submit<const ArenaTreeNode<T>*>(bounds, [this, &tree, target](Query& q) {
+            return bind(q, tree, [target](const T& v) { return v == target; });
+        }, std::move(done));
+    }
+
+    template <typename Callback>
+        requires std::invocable<Callback&, SearchResult<size_t>>
+    void searchAsync(const FlatTree<T>& tree, T target, Callback done, const SearchLimits& bounds = {}) {
+        submit<size_t>(bounds, [this, &tree, target](Query& q) { return bind_target(q, tree, target); }, std::move(done));
+    }
+
+    // Predicate queries. pred(const T&) is a template parameter so it inlines
+    // into the traversal loop. findFirst returns whichever match a worker
+    // reaches first, or under MatchMode::Leftmost the first in DFS order;
+    // findAll returns every match in unspecified order (FlatTree: ascending
+    // preorder index).
+    template <typename Pred>
+    std::shared_ptr<TreeNode<T>> findFirst(const std::shared_ptr<TreeNode<T>>& root, Pred pred) {
+        return first<std::shared_ptr<TreeNode<T>>>(nullptr, [&](Query& q) { return bind(q, root, std::move(pred)); }).match;
+    }
+
+    template <typename Pred>
+    const ArenaTreeNode<T>* findFirst(const ArenaTree<T>& tree, Pred pred) {
+        return first<const ArenaTreeNode<T>*>(nullptr, [&](Query& q) { return bind(q, tree, std::move(pred)); }).match;
+    }
+
+    template <typename Pred>
+    size_t findFirst(const FlatTree<T>& tree, Pred pred) {
+        return first<size_t>(nullptr, [&](Query& q) { return bind(q, tree, std::move(pred)); }).match;
+    }
+
+    template <typename Pred>
+    size_t findFirst(const NumaFlatTree<T>& tree, Pred pred) {
+        const T* values = tree.tree().data();
+        return first<size_t>(nullptr, [&](Query& q) {
+            return bind_placed(q, tree, [values, pred](size_t b, size_t len) {
+                for (size_t i = 0; i < len; ++i)
+                    if (pred(values[b + i])) return i;
+                return len;
             });
+        }).match;
+    }
+
+    // A shallowest match (the root is depth 0) and the path down to it,
+    // without falling back to a sequential BFS: workers search depth-first
+    // in parallel and share the best depth so far, pruning everything at or
+    // below it. When several matches share the smallest depth, which is
+    // returned is unspecified. MatchMode and TraversalOrder don't apply.
+    template <typename Pred>
+    MatchPath<std::shared_ptr<TreeNode<T>>> findShallowest(const std::shared_ptr<TreeNode<T>>& root, Pred pred) {
+        return first_path<SharedLinks>([&](Query& q) {
+            if (!root) return false;
+            q.root = root;
+            bind_shallowest<SharedLinks>(q, &q.root, std::move(pred));
+            return true;
+        });
+    }
+
+    template <typename Pred>
+    MatchPath<const ArenaTreeNode<T>*> findShallowest(const ArenaTree<T>& tree, Pred pred) {
+        return first_path<ArenaLinks>([&](Query& q) {
+            if (!tree.root()) return false;
+            bind_shallowest<ArenaLinks>(q, tree.root(), std::move(pred));
+            return true;
+        });
+    }
+
+    MatchPath<std::shared_ptr<TreeNode<T>>> searchShallowest(const std::shared_ptr<TreeNode<T>>& root, const T& target) {
+        return findShallowest(root, [&target](const T& v) { return v == target; });
+    }
+
+    MatchPath<const ArenaTreeNode<T>*> searchShallowest(const ArenaTree<T>& tree, const T& target) {
+        return findShallowest(tree, [&target](const T& v) { return v == target; });
+    }
+
+    // findFirst() and search() with the path from the root down to the
+    // match. Pointer trees carry it along as work is split between workers;
+    // they are always searched depth-first. FlatTree reads it off the index
+    // ranges afterwards (see FlatTree::pathTo), O(depth) with buildParents().
+    template <typename Pred>
+    MatchPath<std::shared_ptr<TreeNode<T>>> findPath(const std::shared_ptr<TreeNode<T>>& root, Pred pred) {
+        return first_path<SharedLinks>([&](Query& q) {
+            q.paths = true;
+            return bind(q, root, std::move(pred));
+        });
+    }
+
+    template <typename Pred>
+    MatchPath<const ArenaTreeNode<T>*> findPath(const ArenaTree<T>& tree, Pred pred) {
+        return first_path<ArenaLinks>([&](Query& q) {
+            q.paths = true;
+            return bind(q, tree, std::move(pred));
+        });
+    }
+
+    template <typename Pred>
+    MatchPath<size_t> findPath(const FlatTree<T>& tree, Pred pred) {
+        return flat_path(tree, findFirst(tree, std::move(pred)));
+    }
+
+    MatchPath<std::shared_ptr<TreeNode<T>>> searchPath(const std::shared_ptr<TreeNode<T>>& root, const T& target) {
+        return findPath(root, [&target](const T& v) { return v == target; });
+    }
+
+    MatchPath<const ArenaTreeNode<T>*> searchPath(const ArenaTree<T>& tree, const T& target) {
+        return findPath(tree, [&target](const T& v) { return v == target; });
+    }
+
+    MatchPath<size_t> searchPath(const FlatTree<T>& tree, const T& target) {
+        return flat_path(tree, search(tree, target));
+    }
+
+    template <typename Pred>
+    std::vector<std::shared_ptr<TreeNode<T>>> findAll(const std::shared_ptr<TreeNode<T>>& root, Pred pred) {
+        QueryLease q = borrow();
+        if (!root) return {};
+        q->root = root;
+        std::vector<PerWorker<std::vector<std::shared_ptr<TreeNode<T>>>>> buffers(threadCount);
+        auto visit = [&pred, &buffers](size_t self, typename SharedLinks::Handle node) {
+            if (pred(SharedLinks::value(node))) buffers[self].value.push_back(*node);
+            return false;
+        };
+        traverse<SharedLinks>(*q, &q->root, visit);
+        return merge(buffers);
+    }
+
+    template <typename Pred>
+    std::vector<const ArenaTreeNode<T>*> findAll(const ArenaTree<T>& tree, Pred pred) {
+        QueryLease q = borrow();
+        if (!tree.root()) return {};
+        std::vector<PerWorker<std::vector<const ArenaTreeNode<T>*>>> buffers(threadCount);
+        auto visit = [&pred, &buffers](size_t self, typename ArenaLinks::Handle node) {
+            if (pred(ArenaLinks::value(node))) buffers[self].value.push_back(node);
+            return false;
+        };
+        traverse<ArenaLinks>(*q, tree.root(), visit);
+        return merge(buffers);
+    }
+
+    template <typename Pred>
+    std::vector<size_t> findAll(const FlatTree<T>& tree, Pred pred) {
+        QueryLease q = borrow();
+        if (tree.empty()) return {};
+        std::vector<PerWorker<std::vector<size_t>>> buffers(threadCount);
+        const T* values = tree.data();
+        auto visitBlock = [values, &pred, &buffers](size_t self, size_t b, size_t len, size_t&) {
+            auto& out = buffers[self].value;
+            for (size_t i = b; i < b + len; ++i)
+                if (pred(values[i])) out.push_back(i);
+            return false;
+        };
+        scan(*q, tree, visitBlock);
+        auto all = merge(buffers);
+        std::sort(all.begin(), all.end());
+        return all;
+    }
+
+    template <typename Pred>
+    size_t count(const std::shared_ptr<TreeNode<T>>& root, Pred pred) {
+        QueryLease q = borrow();
+        if (!root) return 0;
+        q->root = root;
+        std::vector<PerWorker<size_t>> counts(threadCount);
+        auto visit = [&pred, &counts](size_t self, typename SharedLinks::Handle node) {
+            if (pred(SharedLinks::value(node))) ++counts[self].value;
+            return false;
+        };
+        traverse<SharedLinks>(*q, &q->root, visit);
+        size_t total = 0;
+        for (auto& c : counts) total += c.value;
+        return total;
+    }
+
+    template <typename Pred>
+    size_t count(const ArenaTree<T>& tree, Pred pred) {
+        QueryLease q = borrow();
+        if (!tree.root()) return 0;
+        std::vector<PerWorker<size_t>> counts(threadCount);
+        auto visit = [&pred, &counts](size_t self, typename ArenaLinks::Handle node) {
+            if (pred(ArenaLinks::value(node))) ++counts[self].value;
+            return false;
+        };
+        traverse<ArenaLinks>(*q, tree.root(), visit);
+        size_t total = 0;
+        for (auto& c : counts) total += c.value;
+        return total;
+    }
+
+    template <typename Pred>
+    size_t count(const FlatTree<T>& tree, Pred pred) {
+        QueryLease q = borrow();
+        if (tree.empty()) return 0;
+        std::vector<PerWorker<size_t>> counts(threadCount);
+        const T* values = tree.data();
+        auto visitBlock = [values, &pred, &counts](size_t self, size_t b, size_t len, size_t&) {
+            size_t n = 0;
+            for (size_t i = b; i < b + len; ++i)
+                n += pred(values[i]) ? 1 : 0;
+            counts[self].value += n;
+            return false;
+        };
+        scan(*q, tree, visitBlock);
+        size_t total = 0;
+        for (auto& c : counts) total += c.value;
+        return total;
+    }
+
+    // Look up every target in one traversal. Result i is the node holding
+    // targets[i], or null; the query ends as soon as all targets are found.
+    std::vector<std::shared_ptr<TreeNode<T>>> searchMany(const std::shared_ptr<TreeNode<T>>& root, std::span<const T> targets) {
+        TargetSet<T> set(targets);
+        std::vector<std::shared_ptr<TreeNode<T>>> hits(set.size());
+        QueryLease q = borrow();
+        if (root && !set.empty()) {
+            q->root = root;
+            Query& query = *q;
+            auto visit = [this, &query, &set, &hits](size_t, typename SharedLinks::Handle node) {
+                return retire(query, set, set.find(SharedLinks::value(node)), [&](size_t k) { hits[k] = *node; });
+            };
+            traverse<SharedLinks>(query, &query.root, visit);
         }
+        return set.expand(hits);
+    }
 
-        // Signal stop and join threads
-        stop.store(true);
-        cv.notify_all();
-        for (auto& th : workers) if (th.joinable()) th.join();
-        workers.clear();
+    std::vector<const ArenaTreeNode<T>*> searchMany(const ArenaTree<T>& tree, std::span<const T> targets) {
+        TargetSet<T> set(targets);
+        std::vector<const ArenaTreeNode<T>*> hits(set.size(), nullptr);
+        QueryLease q = borrow();
+        if (tree.root() && !set.empty()) {
+            Query& query = *q;
+            auto visit = [this, &query, &set, &hits](size_t, typename ArenaLinks::Handle node) {
+                return retire(query, set, set.find(ArenaLinks::value(node)), [&](size_t k) { hits[k] = node; });
+            };
+            traverse<ArenaLinks>(query, tree.root(), visit);
+        }
+        return set.expand(hits);
+    }
 
-        return resultNode;
+    // Result i is a preorder index holding targets[i], or FlatTree<T>::npos
+    std::vector<size_t> searchMany(const FlatTree<T>& tree, std::span<const T> targets) {
+        TargetSet<T> set(targets);
+        std::vector<size_t> hits(set.size(), FlatTree<T>::npos);
+        QueryLease q = borrow();
+        if (!tree.empty() && !set.empty()) {
+            Query& query = *q;
+            const T* values = tree.data();
+            auto visitBlock = [this, &query, values, &set, &hits](size_t, size_t b, size_t len, size_t& scanned) {
+                for (size_t i = b; i < b + len; ++i) {
+                    if (retire(query, set, set.find(values[i]), [&](size_t k) { hits[k] = i; })) {
+                        scanned = i - b + 1;
+                        return true;
+                    }
+                }
+                return false;
+            };
+            scan(query, tree, visitBlock);
+        }
+        return set.expand(hits);
+    }
+
+    // Outcome of the latest synchronous query
+    bool isFound() const { return lastFound.load(std::memory_order_relaxed); }
+    size_t getNodesVisited() const { return lastNodesVisited.load(std::memory_order_relaxed); }
+    // Per-worker counters and timings of the latest synchronous query (see
+    // searchstats.hpp); bounded and async queries also return their own in
+    // SearchResult::stats
+    SearchStats getStats() const {
+        std::lock_guard<std::mutex> lk(statsMx);
+        return lastStats;
     }
+    size_t getThreadCount() const { return threadCount; }
+
+    // search()/findFirst() result selection; takes effect from the next query
+    void setMatchMode(MatchMode mode) { matchMode = mode; }
+    MatchMode getMatchMode() const { return matchMode; }
 
-    bool isFound() const { return found.load(std::memory_order_relaxed); }
-    size_t getNodesVisited() const { return nodesVisited.load(std::memory_order_relaxed); }
+    // Pointer-tree search()/findFirst() order; takes effect from the next
+    // query. With Leftmost, breadth-first returns the first match in level
+    // order, and hybrid the first in level order among the levels it
+    // expanded, then the first in DFS order below them.
+    void setTraversalOrder(TraversalOrder o) { order = o; }
+    TraversalOrder getTraversalOrder() const { return order; }
+
+    // Takes effect from the next search()
+    void setSplitPolicy(const SplitPolicy& p) { policy = p; }
+    const SplitPolicy& getSplitPolicy() const { return policy; }
 };
 
+// Prebuilt lean kernels (see LeanSearchTraits): equality search(), findFirst()
+// and friends with an inlined predicate, and searchMany() all compile to
+// traversal loops without statistics or limit polls
+template <typename T>
+using LeanTreeSearch = ParallelTreeSearch<T, LeanSearchTraits>;
+
+using LeanIntTreeSearch = LeanTreeSearch<int>;
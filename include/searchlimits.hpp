@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include "searchstats.hpp"
+
+// Shared cancellation flag; cancel() may be called from any thread
+class CancellationToken
+{
+private:
+    std::atomic<bool> cancelled{false};
+
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    void reset() { cancelled.store(false, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+};
+
+// Bounds on a single query. Workers poll them every LIMIT_CHECK_INTERVAL
+// nodes, so a query may overrun a budget or deadline by about that much
+// work per worker.
+struct SearchLimits
+{
+    using Clock = std::chrono::steady_clock;
+
+    const CancellationToken *cancel = nullptr;
+    Clock::time_point deadline = Clock::time_point::max();
+    // 0 = unlimited
+    size_t maxNodes = 0;
+
+    static SearchLimits within(Clock::duration timeout)
+    {
+        SearchLimits limits;
+        limits.deadline = Clock::now() + timeout;
+        return limits;
+    }
+
+    bool hasDeadline() const { return deadline != Clock::time_point::max(); }
+};
+
+enum class SearchStatus
+{
+    // A match was returned
+    Found,
+    // The whole tree was searched without a match
+    Exhausted,
+    Cancelled,
+    TimedOut,
+    BudgetExceeded
+};
+
+inline const char *toString(SearchStatus status)
+{
+    switch (status)
+    {
+    case SearchStatus::Found:
+        return "found";
+    case SearchStatus::Exhausted:
+        return "exhausted";
+    case SearchStatus::Cancelled:
+        return "cancelled";
+    case SearchStatus::TimedOut:
+        return "timed out";
+    case SearchStatus::BudgetExceeded:
+        return "budget exceeded";
+    }
+    return "unknown";
+}
+
+// Outcome of a bounded query. match is null (or npos) unless a match was
+// found; in MatchMode::Leftmost a query stopped early may still carry a
+// match that is not guaranteed to be the leftmost one.
+template <typename R>
+struct SearchResult
+{
+    R match;
+    SearchStatus status;
+    size_t nodesVisited;
+    SearchStats stats;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <algorithm>
+
+// What one participant seat of a query did
+struct WorkerStats
+{
+    size_t nodesVisited = 0;
+    // Tasks pushed onto this seat's deque (a query's seed tasks start on
+    // seat 0's), and tasks the seat ran, whether its own or stolen
+    size_t tasksSpawned = 0;
+    size_t tasksExecuted = 0;
+    // Tasks taken from other seats' deques, and how many of those came
+    // from another NUMA node (only known when the pool is pinned)
+    size_t steals = 0;
+    size_t remoteSteals = 0;
+    // Time the tasks it ran spent queued, and time it had nothing to run
+    std::chrono::nanoseconds queueWait{0};
+    std::chrono::nanoseconds idle{0};
+
+    WorkerStats &operator+=(const WorkerStats &other)
+    {
+        nodesVisited += other.nodesVisited;
+        tasksSpawned += other.tasksSpawned;
+        tasksExecuted += other.tasksExecuted;
+        steals += other.steals;
+        remoteSteals += other.remoteSteals;
+        queueWait += other.queueWait;
+        idle += other.idle;
+        return *this;
+    }
+};
+
+// Instrumentation for one query. Every seat counts into its own cache
+// line and nothing is summed until the query is over, so collecting it
+// costs the traversal next to nothing.
+struct SearchStats
+{
+    std::vector<WorkerStats> workers;
+    // Sum over workers
+    WorkerStats total;
+    // From launch until the last participant left
+    std::chrono::nanoseconds elapsed{0};
+    // From launch until the first match was reported, if there was one
+    std::optional<std::chrono::nanoseconds> timeToFirstMatch;
+
+    // Busiest seat's nodes over the mean: 1 is an even split, workers.size()
+    // means one seat did everything
+    double imbalance() const
+    {
+        if (workers.empty() || total.nodesVisited == 0)
+        {
+            return 1.0;
+        }
+        size_t busiest = 0;
+        for (const auto &w : workers)
+        {
+            busiest = std::max(busiest, w.nodesVisited);
+        }
+        return static_cast<double>(busiest) * workers.size() / total.nodesVisited;
+    }
+
+    // Append a query that ran after this one (e.g. the next chunk of a stream)
+    SearchStats &operator+=(const SearchStats &later)
+    {
+        if (workers.size() < later.workers.size())
+        {
+            workers.resize(later.workers.size());
+        }
+        for (size_t i = 0; i < later.workers.size(); ++i)
+        {
+            workers[i] += later.workers[i];
+        }
+        total += later.total;
+        if (!timeToFirstMatch && later.timeToFirstMatch)
+        {
+            timeToFirstMatch = elapsed + *later.timeToFirstMatch;
+        }
+        elapsed += later.elapsed;
+        return *this;
+    }
+};
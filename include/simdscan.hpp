@@ -0,0 +1,293 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Vectorized equality scan over a contiguous array. The widest instruction
+// set enabled at compile time (-mavx512f / -mavx2 / x86-64 baseline SSE2) is
+// used for arithmetic types; anything else goes through operator==.
+//
+// Floating-point lanes compare with IEEE semantics (NaN never matches,
+// -0.0 == 0.0), the same as the scalar path.
+
+namespace simd_detail
+{
+    template <typename T>
+    constexpr bool vectorizable = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                                  !std::is_same<T, long double>::value;
+
+    template <typename T>
+    size_t scalarFind(const T *data, size_t n, const T &target)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (data[i] == target)
+                return i;
+        }
+        return n;
+    }
+
+    inline unsigned lowestBit(std::uint64_t mask)
+    {
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+    }
+
+#if defined(__AVX512F__)
+    // One mask bit per lane
+    template <typename T>
+    constexpr bool avx512Supported = (sizeof(T) == 4 || sizeof(T) == 8
+#if defined(__AVX512BW__)
+                                      || sizeof(T) == 1 || sizeof(T) == 2
+#endif
+    );
+
+    template <typename T>
+    inline __m512i avx512Splat(T v)
+    {
+        if constexpr (std::is_same<T, float>::value)
+            return _mm512_castps_si512(_mm512_set1_ps(v));
+        else if constexpr (std::is_same<T, double>::value)
+            return _mm512_castpd_si512(_mm512_set1_pd(v));
+        else if constexpr (sizeof(T) == 8)
+            return _mm512_set1_epi64(static_cast<long long>(v));
+        else if constexpr (sizeof(T) == 4)
+            return _mm512_set1_epi32(static_cast<int>(v));
+        else if constexpr (sizeof(T) == 2)
+            return _mm512_set1_epi16(static_cast<short>(v));
+        else
+            return _mm512_set1_epi8(static_cast<char>(v));
+    }
+
+    template <typename T>
+    inline std::uint64_t avx512Match(const T *p, __m512i needle)
+    {
+        __m512i v = _mm512_loadu_si512(reinterpret_cast<const void *>(p));
+        if constexpr (std::is_same<T, float>::value)
+            return _mm512_cmp_ps_mask(_mm512_castsi512_ps(v), _mm512_castsi512_ps(needle), _CMP_EQ_OQ);
+        else if constexpr (std::is_same<T, double>::value)
+            return _mm512_cmp_pd_mask(_mm512_castsi512_pd(v), _mm512_castsi512_pd(needle), _CMP_EQ_OQ);
+        else if constexpr (sizeof(T) == 8)
+            return _mm512_cmpeq_epi64_mask(v, needle);
+        else if constexpr (sizeof(T) == 4)
+            return _mm512_cmpeq_epi32_mask(v, needle);
+#if defined(__AVX512BW__)
+        else if constexpr (sizeof(T) == 2)
+            return _mm512_cmpeq_epi16_mask(v, needle);
+        else
+            return _mm512_cmpeq_epi8_mask(v, needle);
+#else
+        else
+            return 0;
+#endif
+    }
+
+    template <typename T>
+    size_t avx512Find(const T *data, size_t n, const T &target)
+    {
+        constexpr size_t lanes = 64 / sizeof(T);
+        const __m512i needle = avx512Splat(target);
+        size_t i = 0;
+        // Four vectors per iteration keeps enough loads in flight to saturate bandwidth
+        for (; i + 4 * lanes <= n; i += 4 * lanes)
+        {
+            std::uint64_t m0 = avx512Match(data + i, needle);
+            std::uint64_t m1 = avx512Match(data + i + lanes, needle);
+            std::uint64_t m2 = avx512Match(data + i + 2 * lanes, needle);
+            std::uint64_t m3 = avx512Match(data + i + 3 * lanes, needle);
+            if (m0 | m1 | m2 | m3)
+            {
+                if (m0) return i + lowestBit(m0);
+                if (m1) return i + lanes + lowestBit(m1);
+                if (m2) return i + 2 * lanes + lowestBit(m2);
+                return i + 3 * lanes + lowestBit(m3);
+            }
+        }
+        for (; i + lanes <= n; i += lanes)
+        {
+            if (std::uint64_t m = avx512Match(data + i, needle))
+                return i + lowestBit(m);
+        }
+        return i + scalarFind(data + i, n - i, target);
+    }
+#endif
+
+#if defined(__AVX2__)
+    // Integer lanes report one movemask bit per byte, float lanes one per lane
+    template <typename T>
+    constexpr unsigned avx2BitsPerLane = std::is_floating_point<T>::value ? 1u : static_cast<unsigned>(sizeof(T));
+
+    template <typename T>
+    inline __m256i avx2Splat(T v)
+    {
+        if constexpr (std::is_same<T, float>::value)
+            return _mm256_castps_si256(_mm256_set1_ps(v));
+        else if constexpr (std::is_same<T, double>::value)
+            return _mm256_castpd_si256(_mm256_set1_pd(v));
+        else if constexpr (sizeof(T) == 8)
+            return _mm256_set1_epi64x(static_cast<long long>(v));
+        else if constexpr (sizeof(T) == 4)
+            return _mm256_set1_epi32(static_cast<int>(v));
+        else if constexpr (sizeof(T) == 2)
+            return _mm256_set1_epi16(static_cast<short>(v));
+        else
+            return _mm256_set1_epi8(static_cast<char>(v));
+    }
+
+    template <typename T>
+    inline std::uint32_t avx2Match(const T *p, __m256i needle)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        if constexpr (std::is_same<T, float>::value)
+            return static_cast<std::uint32_t>(_mm256_movemask_ps(
+                _mm256_cmp_ps(_mm256_castsi256_ps(v), _mm256_castsi256_ps(needle), _CMP_EQ_OQ)));
+        else if constexpr (std::is_same<T, double>::value)
+            return static_cast<std::uint32_t>(_mm256_movemask_pd(
+                _mm256_cmp_pd(_mm256_castsi256_pd(v), _mm256_castsi256_pd(needle), _CMP_EQ_OQ)));
+        else if constexpr (sizeof(T) == 8)
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(v, needle)));
+        else if constexpr (sizeof(T) == 4)
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(v, needle)));
+        else if constexpr (sizeof(T) == 2)
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, needle)));
+        else
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+    }
+
+    template <typename T>
+    size_t avx2Find(const T *data, size_t n, const T &target)
+    {
+        constexpr size_t lanes = 32 / sizeof(T);
+        constexpr unsigned bits = avx2BitsPerLane<T>;
+        const __m256i needle = avx2Splat(target);
+        size_t i = 0;
+        for (; i + 4 * lanes <= n; i += 4 * lanes)
+        {
+            std::uint32_t m0 = avx2Match(data + i, needle);
+            std::uint32_t m1 = avx2Match(data + i + lanes, needle);
+            std::uint32_t m2 = avx2Match(data + i + 2 * lanes, needle);
+            std::uint32_t m3 = avx2Match(data + i + 3 * lanes, needle);
+            if (m0 | m1 | m2 | m3)
+            {
+                if (m0) return i + lowestBit(m0) / bits;
+                if (m1) return i + lanes + lowestBit(m1) / bits;
+                if (m2) return i + 2 * lanes + lowestBit(m2) / bits;
+                return i + 3 * lanes + lowestBit(m3) / bits;
+            }
+        }
+        for (; i + lanes <= n; i += lanes)
+        {
+            if (std::uint32_t m = avx2Match(data + i, needle))
+                return i + lowestBit(m) / bits;
+        }
+        return i + scalarFind(data + i, n - i, target);
+    }
+#endif
+
+#if defined(__SSE2__)
+    // SSE2 has no 64-bit integer compare
+    template <typename T>
+    constexpr bool sse2Supported = std::is_floating_point<T>::value || sizeof(T) <= 4;
+
+    template <typename T>
+    constexpr unsigned sse2BitsPerLane = std::is_floating_point<T>::value ? 1u : static_cast<unsigned>(sizeof(T));
+
+    template <typename T>
+    inline __m128i sse2Splat(T v)
+    {
+        if constexpr (std::is_same<T, float>::value)
+            return _mm_castps_si128(_mm_set1_ps(v));
+        else if constexpr (std::is_same<T, double>::value)
+            return _mm_castpd_si128(_mm_set1_pd(v));
+        else if constexpr (sizeof(T) == 4)
+            return _mm_set1_epi32(static_cast<int>(v));
+        else if constexpr (sizeof(T) == 2)
+            return _mm_set1_epi16(static_cast<short>(v));
+        else
+            return _mm_set1_epi8(static_cast<char>(v));
+    }
+
+    template <typename T>
+    inline std::uint32_t sse2Match(const T *p, __m128i needle)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        if constexpr (std::is_same<T, float>::value)
+            return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_castsi128_ps(v), _mm_castsi128_ps(needle))));
+        else if constexpr (std::is_same<T, double>::value)
+            return static_cast<std::uint32_t>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_castsi128_pd(v), _mm_castsi128_pd(needle))));
+        else if constexpr (sizeof(T) == 4)
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(v, needle)));
+        else if constexpr (sizeof(T) == 2)
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(v, needle)));
+        else
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+    }
+
+    template <typename T>
+    size_t sse2Find(const T *data, size_t n, const T &target)
+    {
+        constexpr size_t lanes = 16 / sizeof(T);
+        constexpr unsigned bits = sse2BitsPerLane<T>;
+        const __m128i needle = sse2Splat(target);
+        size_t i = 0;
+        for (; i + 4 * lanes <= n; i += 4 * lanes)
+        {
+            std::uint32_t m0 = sse2Match(data + i, needle);
+            std::uint32_t m1 = sse2Match(data + i + lanes, needle);
+            std::uint32_t m2 = sse2Match(data + i + 2 * lanes, needle);
+            std::uint32_t m3 = sse2Match(data + i + 3 * lanes, needle);
+            if (m0 | m1 | m2 | m3)
+            {
+                if (m0) return i + lowestBit(m0) / bits;
+                if (m1) return i + lanes + lowestBit(m1) / bits;
+                if (m2) return i + 2 * lanes + lowestBit(m2) / bits;
+                return i + 3 * lanes + lowestBit(m3) / bits;
+            }
+        }
+        for (; i + lanes <= n; i += lanes)
+        {
+            if (std::uint32_t m = sse2Match(data + i, needle))
+                return i + lowestBit(m) / bits;
+        }
+        return i + scalarFind(data + i, n - i, target);
+    }
+#endif
+}
+
+// Offset of the first element equal to target in data[0, n), or n if none
+template <typename T>
+size_t simdFindFirst(const T *data, size_t n, const T &target)
+{
+    if constexpr (simd_detail::vectorizable<T>)
+    {
+#if defined(__AVX512F__)
+        if constexpr (simd_detail::avx512Supported<T>)
+            return simd_detail::avx512Find(data, n, target);
+#endif
+#if defined(__AVX2__)
+        return simd_detail::avx2Find(data, n, target);
+#elif defined(__SSE2__)
+        if constexpr (simd_detail::sse2Supported<T>)
+            return simd_detail::sse2Find(data, n, target);
+#endif
+    }
+    return simd_detail::scalarFind(data, n, target);
+}
+
+// Name of the widest kernel compiled in, for benchmark output
+inline const char *simdScanBackend()
+{
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Smallest and largest value in every node's subtree (the node included),
+// kept beside the tree rather than in it: indexed by preorder position for
+// a FlatTree and by id() for an ArenaTree. ParallelTreeSearch::summarize
+// builds it bottom-up in parallel; the search overloads that take it skip
+// any subtree whose [min, max] cannot hold a match. Needs only operator<
+// on T, and pays off when values are clustered by subtree (e.g. ordered
+// data laid out in DFS order); on shuffled data few subtrees are skipped.
+template <typename T>
+class SubtreeSummary
+{
+private:
+    std::vector<T> lows;
+    std::vector<T> highs;
+
+public:
+    SubtreeSummary() = default;
+    explicit SubtreeSummary(size_t n) : lows(n), highs(n) {}
+
+    size_t size() const { return lows.size(); }
+    bool empty() const { return lows.empty(); }
+
+    const T &min(size_t i) const { return lows[i]; }
+    const T &max(size_t i) const { return highs[i]; }
+
+    // Could subtree i hold value?
+    bool mayContain(size_t i, const T &value) const
+    {
+        return !(value < lows[i]) && !(highs[i] < value);
+    }
+
+    // Could subtree i hold anything in [lo, hi]?
+    bool mayOverlap(size_t i, const T &lo, const T &hi) const
+    {
+        return !(hi < lows[i]) && !(highs[i] < lo);
+    }
+
+    // Start node i's summary at its own value, then fold in each child's
+    void set(size_t i, const T &value)
+    {
+        lows[i] = value;
+        highs[i] = value;
+    }
+
+    void include(size_t i, size_t child)
+    {
+        if (lows[child] < lows[i])
+            lows[i] = lows[child];
+        if (highs[i] < highs[child])
+            highs[i] = highs[child];
+    }
+
+    size_t memoryBytes() const { return (lows.capacity() + highs.capacity()) * sizeof(T); }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "simdscan.hpp"
+
+// Up to this many distinct targets are probed with a vectorized linear scan;
+// larger sets go through a hash map
+#ifndef MULTI_TARGET_LINEAR_MAX
+#define MULTI_TARGET_LINEAR_MAX 32
+#endif
+
+// Outstanding targets of a multi-target search. Lookups are read-only and
+// safe from any worker; each distinct target is retired exactly once by
+// whichever worker claims it first.
+template <typename T>
+class TargetSet
+{
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+private:
+    std::vector<T> keys;
+    std::vector<size_t> slotOf;
+    std::unordered_map<T, size_t> lookup;
+    std::unique_ptr<std::atomic<bool>[]> claimed;
+    std::atomic<size_t> remaining{0};
+
+public:
+    explicit TargetSet(std::span<const T> targets)
+    {
+        slotOf.reserve(targets.size());
+        for (const T &t : targets)
+        {
+            auto [it, inserted] = lookup.emplace(t, keys.size());
+            if (inserted)
+                keys.push_back(t);
+            slotOf.push_back(it->second);
+        }
+        if (keys.size() <= MULTI_TARGET_LINEAR_MAX)
+            lookup.clear();
+
+        claimed.reset(new std::atomic<bool>[keys.size()]);
+        for (size_t i = 0; i < keys.size(); ++i)
+            claimed[i].store(false, std::memory_order_relaxed);
+        remaining.store(keys.size(), std::memory_order_relaxed);
+    }
+
+    // Number of distinct targets
+    size_t size() const { return keys.size(); }
+    bool empty() const { return keys.empty(); }
+
+    // Slot of value among the distinct targets, or npos
+    size_t find(const T &value) const
+    {
+        if (keys.size() <= MULTI_TARGET_LINEAR_MAX)
+        {
+            size_t k = simdFindFirst(keys.data(), keys.size(), value);
+            return k < keys.size() ? k : npos;
+        }
+        auto it = lookup.find(value);
+        return it == lookup.end() ? npos : it->second;
+    }
+
+    // True for the one caller that retires slot k
+    bool claim(size_t k)
+    {
+        if (claimed[k].load(std::memory_order_relaxed))
+            return false;
+        if (claimed[k].exchange(true, std::memory_order_acq_rel))
+            return false;
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+    bool isClaimed(size_t k) const { return claimed[k].load(std::memory_order_acquire); }
+
+    // Every distinct target has been claimed
+    bool resolved() const { return remaining.load(std::memory_order_acquire) == 0; }
+
+    // Map per-slot results back onto the caller's target order (duplicates share a result)
+    template <typename R>
+    std::vector<R> expand(const std::vector<R> &perSlot) const
+    {
+        std::vector<R> out;
+        out.reserve(slotOf.size());
+        for (size_t k : slotOf)
+            out.push_back(perSlot[k]);
+        return out;
+    }
+};
@@ -5,65 +5,210 @@
 #include <condition_variable>
 #include <vector>
 #include <queue>
-#include <functional>
 #include <atomic>
 #include <stdexcept>
 #include <utility>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+#include "inlinetask.hpp"
+#include "mpmcqueue.hpp"
+#include "numatopology.hpp"
+
+// Slots in the lock-free backend's ring; tasks beyond that spill into the locked queue
+#ifndef THREADPOOL_RING_CAPACITY
+#define THREADPOOL_RING_CAPACITY 4096
+#endif
+
+// Empty polls a lock-free worker makes before parking
+#ifndef THREADPOOL_SPIN_ROUNDS
+#define THREADPOOL_SPIN_ROUNDS 64
+#endif
+
+enum class QueueBackend
+{
+    // std::queue behind queueMutex; every enqueue takes the lock and signals the condition
+    Locked,
+    // Bounded MPMC ring; idle workers spin before parking, and enqueue only
+    // touches the mutex when someone is actually parked
+    LockFree
+};
 
 template <typename T>
 class ThreadPool
 {
 private:
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
+    // Locked backend: the task queue. LockFree backend: overflow when the ring is full
+    std::queue<InlineTask> tasks;
     std::mutex queueMutex;
     std::condition_variable condition;
     std::atomic<bool> stop;
     std::atomic<int> available_threads;
     const int maxThreads;
     std::atomic<int> activeTasks{0};
+    std::atomic<int> queuedTasks{0};
+
+    const QueueBackend backend;
+    const WorkerPinning pinning;
+    std::unique_ptr<MpmcQueue<InlineTask>> ring;
+    std::atomic<size_t> overflowed{0};
+    // LockFree parking: wakeEpoch changes (under queueMutex) whenever parked workers should look again
+    std::atomic<std::uint64_t> wakeEpoch{0};
+    std::atomic<size_t> sleepers{0};
+
+    bool tryTake(InlineTask &task)
+    {
+        if (ring->tryPop(task))
+        {
+            queuedTasks--;
+            return true;
+        }
+        if (overflowed.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.front());
+                tasks.pop();
+                overflowed--;
+                queuedTasks--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Block until there is a task to run; false once stopped and drained
+    bool nextTask(InlineTask &task)
+    {
+        if (backend == QueueBackend::Locked)
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            condition.wait(lock, [this]
+                           { return stop.load() || !tasks.empty(); });
+            if (tasks.empty())
+            {
+                return false;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+            queuedTasks--;
+            return true;
+        }
+
+        size_t spins = 0;
+        while (true)
+        {
+            if (tryTake(task))
+            {
+                return true;
+            }
+            if (++spins < THREADPOOL_SPIN_ROUNDS)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::uint64_t epoch = wakeEpoch.load(std::memory_order_acquire);
+            // Pairs with the fence in wake(): either we see the task or the producer sees us
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            if (tryTake(task))
+            {
+                sleepers.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                condition.wait(lock, [&]
+                               { return wakeEpoch.load(std::memory_order_relaxed) != epoch || stop.load(); });
+            }
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+            if (stop.load())
+            {
+                return tryTake(task);
+            }
+            spins = 0;
+        }
+    }
+
+    void push(InlineTask task)
+    {
+        activeTasks++;
+        queuedTasks++;
+        if (!ring->tryPush(std::move(task)))
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.push(std::move(task));
+            overflowed++;
+        }
+    }
+
+    // LockFree: wake parked workers, if there are any, after publishing tasks
+    void wake(bool all)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            wakeEpoch.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (all)
+            condition.notify_all();
+        else
+            condition.notify_one();
+    }
 
 public:
-    explicit ThreadPool(size_t numThreads) : maxThreads(numThreads), stop(false), available_threads(numThreads)
+    // With pinning other than None, each worker binds itself to one CPU of
+    // NumaTopology::system() before taking its first task
+    explicit ThreadPool(size_t numThreads, QueueBackend queueBackend = QueueBackend::Locked,
+                        WorkerPinning workerPinning = WorkerPinning::None)
+        : stop(false), available_threads(numThreads), maxThreads(numThreads), backend(queueBackend),
+          pinning(workerPinning)
     {
+        if (backend == QueueBackend::LockFree)
+        {
+            ring = std::make_unique<MpmcQueue<InlineTask>>(THREADPOOL_RING_CAPACITY);
+        }
         for (size_t i = 0; i < numThreads; ++i)
         {
-            workers.emplace_back([this]
+            workers.emplace_back([this, i]
                                  {
+                int cpu = NumaTopology::system().cpuFor(pinning, i);
+                if (cpu >= 0)
+                {
+                    pinCurrentThreadToCpu(cpu);
+                }
+
                 while(true){
-                    
-                    std::function<void()> task;
-                    
-                    {
-                        std::unique_lock<std::mutex> lock(queueMutex);
-                        condition.wait(lock, [this]{
-                            return stop.load() || !tasks.empty();
-                        });
-
-                        if(stop.load() && tasks.empty()){
-                            return;
-                        }
-
-                        if(!tasks.empty()){
-                            task = std::move(tasks.front());
-                            tasks.pop();
-                        }
-                    }
 
-                    if(task){
-                        available_threads--;
-                        task();
-                        activeTasks--;
-                        available_threads++;
+                    InlineTask task;
+                    if(!nextTask(task)){
+                        return;
                     }
 
+                    available_threads--;
+                    task();
+                    activeTasks--;
+                    available_threads++;
+
                 } });
         }
     }
 
     ~ThreadPool()
     {
-        stop = true;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stop = true;
+            wakeEpoch.fetch_add(1, std::memory_order_relaxed);
+        }
         condition.notify_all();
         for (auto &worker : workers)
         {
@@ -72,6 +217,31 @@ public:
         }
     }
 
+    // Process-wide pool with one thread per hardware thread, created on first
+    // use. Anything that would otherwise start its own threads can share it
+    // instead, so concurrent users don't oversubscribe the cores.
+    static std::shared_ptr<ThreadPool> shared()
+    {
+        static std::shared_ptr<ThreadPool> pool =
+            std::make_shared<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+        return pool;
+    }
+
+    size_t getThreadCount() const
+    {
+        return static_cast<size_t>(maxThreads);
+    }
+
+    QueueBackend getBackend() const
+    {
+        return backend;
+    }
+
+    WorkerPinning getPinning() const
+    {
+        return pinning;
+    }
+
     bool hasAvailableThread() const
     {
         return available_threads.load() > 0;
@@ -87,9 +257,32 @@ public:
         return activeTasks.load();
     }
 
+    // Tasks enqueued but not yet picked up by a worker
+    int getQueuedTaskCount() const
+    {
+        return queuedTasks.load();
+    }
+
+    // More work is queued than there are idle workers to pick it up
+    bool hasWaitingTasks() const
+    {
+        return queuedTasks.load(std::memory_order_relaxed) > available_threads.load(std::memory_order_relaxed);
+    }
+
     template <class F>
     void enqueue(F &&f)
     {
+        if (backend == QueueBackend::LockFree)
+        {
+            if (stop.load())
+            {
+                throw std::runtime_error("Cannot enqueue on stopped ThreadPool");
+            }
+            push(InlineTask(std::forward<F>(f)));
+            wake(false);
+            return;
+        }
+
         {
             std::unique_lock<std::mutex> lock(queueMutex);
             if (stop.load())
@@ -98,7 +291,51 @@ public:
             }
             tasks.emplace(std::forward<F>(f));
             activeTasks++;
+            queuedTasks++;
         }
         condition.notify_one();
     }
-};
\ No newline at end of file
+
+    // Publish every task in [first, last) (moved from) with a single wakeup
+    template <class It>
+    void enqueueBatch(It first, It last)
+    {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n == 0)
+        {
+            return;
+        }
+
+        if (backend == QueueBackend::LockFree)
+        {
+            if (stop.load())
+            {
+                throw std::runtime_error("Cannot enqueue on stopped ThreadPool");
+            }
+            for (; first != last; ++first)
+            {
+                push(InlineTask(std::move(*first)));
+            }
+            wake(n > 1);
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            if (stop.load())
+            {
+                throw std::runtime_error("Cannot enqueue on stopped ThreadPool");
+            }
+            for (; first != last; ++first)
+            {
+                tasks.emplace(std::move(*first));
+            }
+            activeTasks += static_cast<int>(n);
+            queuedTasks += static_cast<int>(n);
+        }
+        if (n > 1)
+            condition.notify_all();
+        else
+            condition.notify_one();
+    }
+};
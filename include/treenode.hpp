@@ -3,20 +3,87 @@
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Structure version for the part of a tree one or more TreeIndex objects
+// cover. buildIndex stamps the nodes it indexes with one, and addChild on a
+// stamped node bumps it, so only the indexes over that tree go stale. Each
+// build worker stamps with its own watch, so each gets a cache line.
+// Stamped nodes and the indexes using a watch own it through refs; the
+// last of them deletes it.
+struct alignas(64) TreeWatch
+{
+    std::atomic<std::uint64_t> version{0};
+    std::atomic<size_t> refs{1};
+
+    void retain(size_t n = 1)
+    {
+        refs.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static void release(TreeWatch *watch)
+    {
+        if (watch->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete watch;
+        }
+    }
+};
 
 template <typename T>
 class TreeNode
 {
 public:
     T data;
-    std::vector<std::shared_ptr<TreeNode<T>>> children;
+    // Caller-managed; ParallelTreeSearch never reads it. ArenaTreeNode is the
+    // slim variant without it, with visitation kept in VisitEpochs instead.
+    // Kept beside data, where a small T leaves padding for it.
     mutable std::atomic<bool> visited;
+    std::vector<std::shared_ptr<TreeNode<T>>> children;
+
+    // Set once, by the first TreeIndex to cover the node; null for
+    // unindexed nodes. The node holds a reference to the watch.
+    std::atomic<TreeWatch *> watch{nullptr};
 
     explicit TreeNode(const T &value) : data(value), visited(false) {}
 
+    // Iterative, so tearing down a deep or skewed tree can't overflow the
+    // stack: descendants this node solely owns are unlinked onto a worklist
+    // and die childless. Subtrees still referenced elsewhere are left intact.
+    ~TreeNode()
+    {
+        if (TreeWatch *w = watch.load(std::memory_order_acquire))
+        {
+            TreeWatch::release(w);
+        }
+        if (children.empty())
+        {
+            return;
+        }
+        std::vector<std::shared_ptr<TreeNode<T>>> pending = std::move(children);
+        while (!pending.empty())
+        {
+            std::shared_ptr<TreeNode<T>> node = std::move(pending.back());
+            pending.pop_back();
+            if (node && node.use_count() == 1)
+            {
+                for (auto &child : node->children)
+                {
+                    pending.push_back(std::move(child));
+                }
+                node->children.clear();
+            }
+        }
+    }
+
     void addChild(std::shared_ptr<TreeNode<T>> child)
     {
-        children.push_back(child);
+        children.push_back(std::move(child));
+        if (TreeWatch *w = watch.load(std::memory_order_acquire))
+        {
+            w->version.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
     bool isLeaf() const
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <future>
+#include <algorithm>
+
+#include "treenode.hpp"
+#include "threadpool.hpp"
+
+// Subtrees per pool worker handed out by destroyTreeAsync
+#ifndef TEARDOWN_SUBTREES_PER_WORKER
+#define TEARDOWN_SUBTREES_PER_WORKER 4
+#endif
+
+// Most levels destroyTreeAsync unlinks on the calling thread
+#ifndef TEARDOWN_CALLER_LEVELS
+#define TEARDOWN_CALLER_LEVELS 16
+#endif
+
+// Free a shared_ptr tree on pool's workers and return at once. The top
+// levels are unlinked on the calling thread until there are a few subtrees
+// per worker; each job then frees a batch of them (iteratively, through
+// ~TreeNode). The caller stops early, after TEARDOWN_CALLER_LEVELS levels
+// or once a level stops growing, so a chain or skewed tree goes to the pool
+// nearly whole. The future is ready once every node is gone. Nodes still
+// referenced elsewhere survive, along with everything below them.
+//
+// pool must outlive the teardown.
+template <typename T>
+std::future<void> destroyTreeAsync(std::shared_ptr<TreeNode<T>> root, ThreadPool<void> &pool)
+{
+    using NodePtr = std::shared_ptr<TreeNode<T>>;
+
+    struct Teardown
+    {
+        std::atomic<size_t> remaining;
+        std::promise<void> done;
+    };
+
+    size_t want = TEARDOWN_SUBTREES_PER_WORKER * pool.getThreadCount();
+    std::vector<NodePtr> level;
+    if (root)
+    {
+        level.push_back(std::move(root));
+    }
+    for (int depth = 0; depth < TEARDOWN_CALLER_LEVELS && !level.empty() && level.size() < want; ++depth)
+    {
+        std::vector<NodePtr> next;
+        for (auto &node : level)
+        {
+            if (node.use_count() == 1)
+            {
+                for (auto &child : node->children)
+                {
+                    next.push_back(std::move(child));
+                }
+                node->children.clear();
+            }
+        }
+        bool grew = next.size() > level.size();
+        level = std::move(next);
+        if (!grew)
+        {
+            break;
+        }
+    }
+
+    auto teardown = std::make_shared<Teardown>();
+    std::future<void> finished = teardown->done.get_future();
+    if (level.empty())
+    {
+        teardown->done.set_value();
+        return finished;
+    }
+
+    size_t jobs = std::min(level.size(), want);
+    teardown->remaining.store(jobs, std::memory_order_relaxed);
+    std::vector<InlineTask> batch;
+    batch.reserve(jobs);
+    for (size_t j = 0; j < jobs; ++j)
+    {
+        size_t begin = level.size() * j / jobs;
+        size_t end = level.size() * (j + 1) / jobs;
+        std::vector<NodePtr> subtrees(std::make_move_iterator(level.begin() + begin),
+                                      std::make_move_iterator(level.begin() + end));
+        batch.push_back([subtrees = std::move(subtrees), teardown]() mutable
+                        {
+            subtrees.clear();
+            if (teardown->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                teardown->done.set_value();
+            } });
+    }
+    pool.enqueueBatch(batch.begin(), batch.end());
+    return finished;
+}
+
+// Free a shared_ptr tree using every worker of pool and wait for it
+template <typename T>
+void destroyTree(std::shared_ptr<TreeNode<T>> root, ThreadPool<void> &pool)
+{
+    destroyTreeAsync(std::move(root), pool).wait();
+}
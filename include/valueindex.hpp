@@ -0,0 +1,257 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+
+#include "treenode.hpp"
+
+template <typename T, typename Traits>
+class ParallelTreeSearch;
+
+// Exact-match lookup table from node value to node, split into
+// hash partitions so ParallelTreeSearch can build and merge the partitions
+// in parallel. Each entry remembers whether its value occurs more than
+// once, since the node kept for a repeated value is not necessarily the
+// one a DFS would reach first.
+template <typename T, typename Ref>
+class ValueIndex
+{
+public:
+    struct Entry
+    {
+        Ref ref;
+        // False once a second node with the same value was seen
+        bool unique = true;
+    };
+
+    using Partition = std::unordered_map<T, Entry>;
+
+    const Entry *find(const T &value) const
+    {
+        if (parts.empty())
+        {
+            return nullptr;
+        }
+        const Partition &part = parts[partitionOf(value, parts.size())];
+        auto it = part.find(value);
+        return it == part.end() ? nullptr : &it->second;
+    }
+
+    // Distinct values indexed
+    size_t size() const
+    {
+        size_t n = 0;
+        for (const auto &part : parts)
+        {
+            n += part.size();
+        }
+        return n;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static size_t partitionOf(const T &value, size_t partitions)
+    {
+        return std::hash<T>{}(value) % partitions;
+    }
+
+protected:
+    template <typename, typename>
+    friend class ParallelTreeSearch;
+
+    std::vector<Partition> parts;
+};
+
+// Index over a FlatTree: each value maps to its lowest preorder index, the
+// node a sequential DFS finds. FlatTree is immutable, so it never goes stale.
+template <typename T>
+using FlatIndex = ValueIndex<T, size_t>;
+
+// Index over a shared_ptr tree, built by ParallelTreeSearch::buildIndex.
+// It holds the root, so a search through a stale index can fall back to
+// walking the tree. The build stamps every node it covers with a TreeWatch
+// (keeping any stamp an earlier index left there), and an addChild on one
+// of those nodes makes the index stale; other trees are not watched.
+// Growing the tree through the index's own addChild keeps it current
+// instead. Changes made to children directly are not seen at all.
+//
+// Stamps are atomic, so several searchers may index one tree at once, but
+// the tree must not change while an index over it is being built.
+template <typename T>
+class TreeIndex : public ValueIndex<T, std::shared_ptr<TreeNode<T>>>
+{
+public:
+    using Node = std::shared_ptr<TreeNode<T>>;
+
+    // A watch covering some of the tree, and its version when last seen.
+    // The index holds one reference to each watch it uses.
+    struct Watched
+    {
+        std::shared_ptr<TreeWatch> watch;
+        std::uint64_t version = 0;
+    };
+
+    const Node &root() const { return treeRoot; }
+
+    // True while no node of the tree gained a child since the index was
+    // built (or since its own last addChild)
+    bool current() const
+    {
+        if (watched.empty())
+        {
+            return false;
+        }
+        for (const auto &w : watched)
+        {
+            if (w.watch->version.load(std::memory_order_relaxed) != w.version)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // parent->addChild(child), also indexing child's subtree. If anything
+    // else changed this tree in the meantime the index just stays stale.
+    void addChild(const Node &parent, Node child)
+    {
+        bool wasCurrent = current();
+        TreeWatch *stamp = parent->watch.load(std::memory_order_acquire);
+        Watched *own = stamp ? watchedEntry(stamp) : nullptr;
+        std::uint64_t before = own ? stamp->version.load(std::memory_order_relaxed) : 0;
+        parent->addChild(child);
+        if (!wasCurrent || !own || stamp->version.load(std::memory_order_relaxed) != before + 1)
+        {
+            return;
+        }
+        own->version = before + 1;
+
+        Cover covered;
+        covered.own = stamp;
+        std::vector<Node> pending{std::move(child)};
+        while (!pending.empty())
+        {
+            Node node = std::move(pending.back());
+            pending.pop_back();
+            if (!node)
+            {
+                continue;
+            }
+            cover(*node, covered);
+            auto &part = this->parts[ValueIndex<T, Node>::partitionOf(node->data, this->parts.size())];
+            auto [it, inserted] = part.try_emplace(node->data, typename ValueIndex<T, Node>::Entry{node, true});
+            if (!inserted)
+            {
+                it->second.unique = false;
+            }
+            for (const auto &c : node->children)
+            {
+                pending.push_back(c);
+            }
+        }
+        adopt(covered);
+    }
+
+private:
+    template <typename, typename>
+    friend class ParallelTreeSearch;
+
+    // What one build worker (or addChild) did: the nodes it stamped with
+    // own, whose references it hands over to own in one go when it is
+    // destroyed, and the watches of other indexes it came across
+    struct Cover
+    {
+        TreeWatch *own = nullptr;
+        size_t stamped = 0;
+        std::vector<Watched> seen;
+
+        Cover() = default;
+        Cover(const Cover &) = delete;
+        Cover &operator=(const Cover &) = delete;
+
+        ~Cover()
+        {
+            if (stamped != 0)
+            {
+                own->retain(stamped);
+            }
+        }
+    };
+
+    Node treeRoot;
+    std::vector<Watched> watched;
+
+    // An index's reference to watch
+    static std::shared_ptr<TreeWatch> share(TreeWatch *watch)
+    {
+        watch->retain();
+        return std::shared_ptr<TreeWatch>(watch, &TreeWatch::release);
+    }
+
+    Watched *watchedEntry(const TreeWatch *watch)
+    {
+        for (auto &w : watched)
+        {
+            if (w.watch.get() == watch)
+            {
+                return &w;
+            }
+        }
+        return nullptr;
+    }
+
+    // Stamp node with covered.own unless some index got there first; a
+    // watch of another index is noted in covered.seen, versioned as of now
+    static void cover(TreeNode<T> &node, Cover &covered)
+    {
+        TreeWatch *found = node.watch.load(std::memory_order_acquire);
+        if (!found && node.watch.compare_exchange_strong(found, covered.own, std::memory_order_acq_rel,
+                                                         std::memory_order_acquire))
+        {
+            ++covered.stamped;
+            return;
+        }
+        if (found == covered.own)
+        {
+            return;
+        }
+        for (auto it = covered.seen.rbegin(); it != covered.seen.rend(); ++it)
+        {
+            if (it->watch.get() == found)
+            {
+                return;
+            }
+        }
+        covered.seen.push_back({share(found), found->version.load(std::memory_order_relaxed)});
+    }
+
+    // Called by buildIndex before it walks the tree: one fresh watch per
+    // build worker, so stamping never shares a reference count
+    void watch(Node root, size_t partitions, size_t workers)
+    {
+        treeRoot = std::move(root);
+        watched.clear();
+        for (size_t i = 0; i < workers; ++i)
+        {
+            watched.push_back({std::shared_ptr<TreeWatch>(new TreeWatch, &TreeWatch::release), 0});
+        }
+        this->parts.assign(partitions, {});
+    }
+
+    // Start watching what covered came across
+    void adopt(const Cover &covered)
+    {
+        for (const auto &w : covered.seen)
+        {
+            if (!watchedEntry(w.watch.get()))
+            {
+                watched.push_back(w);
+            }
+        }
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Visitation state kept outside the nodes, indexed by a dense node id
+// (ArenaTreeNode::id() or a FlatTree index). Each query stamps nodes with the
+// current epoch, so starting a new query is O(1) instead of a reset pass over
+// the whole tree; the array is only cleared when the epoch counter wraps.
+class VisitEpochs
+{
+private:
+    std::unique_ptr<std::atomic<std::uint32_t>[]> stamps;
+    size_t count = 0;
+    std::uint32_t epoch = 0;
+
+    void clearStamps()
+    {
+        for (size_t i = 0; i < count; ++i)
+            stamps[i].store(0, std::memory_order_relaxed);
+    }
+
+public:
+    VisitEpochs() = default;
+    explicit VisitEpochs(size_t nodeCount) { resize(nodeCount); }
+
+    // Drops all marks
+    void resize(size_t nodeCount)
+    {
+        stamps.reset(new std::atomic<std::uint32_t>[nodeCount]);
+        count = nodeCount;
+        epoch = 0;
+        clearStamps();
+    }
+
+    size_t size() const { return count; }
+
+    // Start a new query; not thread-safe against concurrent marking
+    void beginEpoch()
+    {
+        if (++epoch == 0)
+        {
+            clearStamps();
+            epoch = 1;
+        }
+    }
+
+    // True for the first caller to mark id in this epoch
+    bool markVisited(size_t id)
+    {
+        return stamps[id].exchange(epoch, std::memory_order_relaxed) != epoch;
+    }
+
+    bool isVisited(size_t id) const
+    {
+        return epoch != 0 && stamps[id].load(std::memory_order_relaxed) == epoch;
+    }
+};
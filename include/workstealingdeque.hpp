@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque (Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models"). The owning thread pushes and pops
+// at the bottom (LIFO); any other thread steals from the top (FIFO).
+//
+// Elements must be trivially copyable. Slots are stored as relaxed atomic
+// words so a thief racing with a wrapped-around push reads a stale value
+// instead of tearing; the CAS on top then rejects it.
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque requires a trivially copyable T");
+    static_assert(std::is_default_constructible<T>::value, "WorkStealingDeque requires a default constructible T");
+
+private:
+    static constexpr size_t Words = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    struct Slot
+    {
+        std::atomic<std::uint64_t> words[Words];
+    };
+
+    struct Buffer
+    {
+        const std::int64_t capacity;
+        const std::int64_t mask;
+        std::unique_ptr<Slot[]> slots;
+
+        explicit Buffer(std::int64_t cap) : capacity(cap), mask(cap - 1), slots(new Slot[cap]) {}
+
+        void put(std::int64_t i, const T &value)
+        {
+            std::uint64_t raw[Words] = {};
+            std::memcpy(raw, &value, sizeof(T));
+            Slot &s = slots[i & mask];
+            for (size_t w = 0; w < Words; ++w)
+                s.words[w].store(raw[w], std::memory_order_relaxed);
+        }
+
+        T get(std::int64_t i) const
+        {
+            std::uint64_t raw[Words];
+            const Slot &s = slots[i & mask];
+            for (size_t w = 0; w < Words; ++w)
+                raw[w] = s.words[w].load(std::memory_order_relaxed);
+            T value;
+            std::memcpy(&value, raw, sizeof(T));
+            return value;
+        }
+    };
+
+    alignas(64) std::atomic<std::int64_t> top{0};
+    alignas(64) std::atomic<std::int64_t> bottom{0};
+    std::atomic<Buffer *> buffer;
+
+    // Buffers replaced by a grow stay alive until destruction: a thief may
+    // still be reading from one. Only the owner touches this list.
+    std::vector<std::unique_ptr<Buffer>> buffers;
+
+    Buffer *grow(Buffer *old, std::int64_t t, std::int64_t b)
+    {
+        auto next = std::make_unique<Buffer>(old->capacity * 2);
+        for (std::int64_t i = t; i < b; ++i)
+            next->put(i, old->get(i));
+        Buffer *raw = next.get();
+        buffers.push_back(std::move(next));
+        buffer.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+public:
+    explicit WorkStealingDeque(size_t initialCapacity = 256)
+    {
+        std::int64_t cap = 1;
+        while (cap < static_cast<std::int64_t>(initialCapacity))
+            cap <<= 1;
+        buffers.push_back(std::make_unique<Buffer>(cap));
+        buffer.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    // Owner only
+    void push(const T &value)
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        Buffer *a = buffer.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1)
+            a = grow(a, t, b);
+        a->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only
+    bool pop(T &out)
+    {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer *a = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out = a->get(b);
+        if (t == b)
+        {
+            // Last element: race the thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread
+    bool steal(T &out)
+    {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+
+        Buffer *a = buffer.load(std::memory_order_acquire);
+        out = a->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // Approximate when called concurrently with push/pop/steal
+    bool empty() const
+    {
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        return t >= b;
+    }
+
+    size_t size() const
+    {
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    // Owner only, and only while no thief can be running
+    void clear()
+    {
+        bottom.store(top.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+};
@@ -5,18 +5,6 @@
 #include <iostream>
 #include <memory>
 
-template <typename T>
-void resetTree(std::shared_ptr<TreeNode<T>> node)
-{
-    if (!node)
-        return;
-    node->visited.store(false);
-    for (auto &child : node->children)
-    {
-        resetTree(child);
-    }
-}
-
 template <typename T>
 std::shared_ptr<TreeNode<T>> createSampleTree()
 {
@@ -69,9 +57,7 @@ int main()
     {
         std::cout << "\nSearching for: " << target << std::endl;
 
-        // Reset tree before each search
-        resetTree(tree);
-
+        // No reset pass: the searcher keeps no state in the nodes
         auto result = searcher.search(tree, target);
 
         if (result != nullptr)
@@ -0,0 +1,69 @@
+// Leftmost mode must return exactly the match a sequential DFS finds, even
+// once splitting has narrowed a task's key interval to a single key while
+// many other nodes match too.
+//
+// g++ -std=c++20 -O2 -pthread -Iinclude tests/leftmost_ties.cpp -o leftmost_ties && ./leftmost_ties
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "paralleltreesearch.hpp"
+
+using Node = std::shared_ptr<TreeNode<int>>;
+
+// A comb: a spine of nodes holding 0, each with the next spine node first
+// and then a matching leaf (1). DFS runs down the whole spine before any
+// leaf, so the first match is the deepest spine node's leaf; every split
+// hands the thieves shallower leaves, all of them duplicates of it. Each
+// split halves the spine task's key interval, so a spine of a few thousand
+// nodes narrows it to a single key.
+static Node makeComb(int depth, Node &firstMatch)
+{
+    Node root = std::make_shared<TreeNode<int>>(0);
+    Node spine = root;
+    for (int d = 0; d < depth; ++d)
+    {
+        Node next = std::make_shared<TreeNode<int>>(0);
+        Node leaf = std::make_shared<TreeNode<int>>(1);
+        spine->addChild(next);
+        spine->addChild(leaf);
+        firstMatch = leaf;
+        spine = next;
+    }
+    return root;
+}
+
+int main()
+{
+    Node expected;
+    Node root = makeComb(3000, expected);
+
+    // Yielding on every node lets idle workers steal (and so force a split)
+    // between any two visits, even on a single core
+    auto isOne = [](int v)
+    {
+        std::this_thread::yield();
+        return v == 1;
+    };
+
+    int failures = 0;
+    for (size_t threads : {2, 3, 4, 8})
+    {
+        ParallelTreeSearch<int> searcher(threads);
+        searcher.setMatchMode(MatchMode::Leftmost);
+        int wrong = 0;
+        for (int rep = 0; rep < 50; ++rep)
+        {
+            if (searcher.findFirst(root, isOne) != expected)
+            {
+                ++wrong;
+            }
+        }
+        std::printf("%zu threads: %d of 50 leftmost searches returned a later match\n", threads, wrong);
+        failures += wrong;
+    }
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}